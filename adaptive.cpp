@@ -0,0 +1,303 @@
+/* adaptive.cpp - Adaptive meta-policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "adaptive.h"
+using namespace std;
+
+const char* AdaptiveCache::names[ADAPTIVE_CANDIDATES] = {"LRU", "LFU", "LIRS", "ARC", "CACHEUS"};
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+AdaptiveCache::AdaptiveCache(int n) {
+    csize = n;
+    // the sparsest sample that still leaves every shadow a useful size
+    shift = 0;
+    while (shift < ADAPTIVE_MAX_SHIFT && (csize >> (shift + 1)) >= ADAPTIVE_MIN_SHADOW) shift++;
+    shadowSize = max(1, csize >> shift);
+
+    current = 0;
+    active = make(current, csize);
+    active->setEvictionSink(this);
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        shadows[i] = make(i, shadowSize);
+        score[i] = 0;
+        windowHits[i] = 0;
+        served[i] = 0;
+        shadowHits[i] = 0;
+    }
+    windowSamples = 0;
+    time = 0;
+    trajectory.push_back(std::make_pair(0LL, current));
+
+    // Initialize statistics variables
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    switches = 0;
+    sampled = 0;
+    migration = 0;
+    total_migration = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "Adaptive Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << ", Candidates: LRU LFU LIRS ARC CACHEUS, Sample: 1/" << (1 << shift) << ", Shadow size: " << shadowSize << ", Starting with: " << names[current] << std::endl;
+}
+
+AdaptiveCache::~AdaptiveCache() {
+    delete active;
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        delete shadows[i];
+    }
+}
+
+// ------------------------------------------------------------------
+// Meta-policy Helper Functions
+// ------------------------------------------------------------------
+PagePolicy* AdaptiveCache::make(int candidate, int n) {
+    switch (candidate) {
+    case 0: return new PolicyAdapter<LRUCache>(n);
+    case 1: return new PolicyAdapter<LFUCache>(n);
+    case 2: return new PolicyAdapter<LIRSCache>(n);
+    case 3: return new PolicyAdapter<ARCCache>(n);
+    default: return new PolicyAdapter<CACHEUSCache>(n);
+    }
+}
+
+bool AdaptiveCache::in_sample(long long int x) {
+    if (shift == 0) return true;
+    // splitmix64 finaliser, the top bits pick the sample
+    unsigned long long z = (unsigned long long)x + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (z >> (64 - shift)) == 0;
+}
+
+void AdaptiveCache::decide() {
+    int best = current;
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        score[i] = score[i] * ADAPTIVE_DECAY + windowHits[i];
+        windowHits[i] = 0;
+        if (score[i] > score[best]) best = i;
+    }
+    windowSamples = 0;
+    // hysteresis: a near tie is not worth the cost of a switch
+    if (best != current && score[best] > score[current] * (1 + ADAPTIVE_MARGIN)) {
+        switch_to(best);
+    }
+}
+
+void AdaptiveCache::switch_to(int candidate) {
+    // The new policy starts from the resident pages of the old one, installed
+    // from the old policy's next victim to its most protected page, so nothing
+    // is evicted or written back by the switch itself
+    std::vector<std::pair<long long int, bool> > keys;
+    active->residents(keys);
+    PagePolicy* next = make(candidate, csize);
+    next->setPageSize(page_size);
+    next->setEvictionSink(this);
+    for (size_t i = 0; i < keys.size(); i++) {
+        next->install(keys[i].first, keys[i].second ? "Write" : "Read");
+    }
+    delete active;
+    active = next;
+    current = candidate;
+    switches++;
+    trajectory.push_back(std::make_pair(time, current));
+}
+
+void AdaptiveCache::evicted(long long int x, bool dirty) {
+    if (dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(x, dirty);
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core meta-policy Logic)
+// ------------------------------------------------------------------
+bool AdaptiveCache::refer(long long int x, string rwtype) {
+    calls++;
+    time++;
+    served[current]++;
+
+    bool hit = active->refer(x, rwtype);
+    if (hit) {
+        hits++;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+    } else {
+        migration++;
+        total_migration++;
+    }
+
+    if (in_sample(x)) {
+        sampled++;
+        for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+            if (shadows[i]->refer(x, rwtype)) {
+                windowHits[i]++;
+                shadowHits[i]++;
+            }
+        }
+        if (++windowSamples >= ADAPTIVE_WINDOW_SAMPLES) {
+            decide();
+        }
+    }
+    return hit;
+}
+
+bool AdaptiveCache::contains(long long int x) {
+    return active->contains(x);
+}
+
+bool AdaptiveCache::install(long long int x, string rwtype) {
+    // the shadows see the same prefetches as the live policy
+    if (in_sample(x)) {
+        for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) shadows[i]->install(x, rwtype);
+    }
+    return active->install(x, rwtype);
+}
+
+bool AdaptiveCache::remove(long long int x) {
+    if (in_sample(x)) {
+        for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) shadows[i]->remove(x);
+    }
+    return active->remove(x);
+}
+
+long long int AdaptiveCache::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+void AdaptiveCache::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+void AdaptiveCache::setPageSize(int n) {
+    page_size = n;
+    active->setPageSize(n);
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) shadows[i]->setPageSize(n);
+}
+
+void AdaptiveCache::resize(int n) {
+    csize = n;
+    // the sample rate stays, the shadows keep their share of the cache
+    shadowSize = max(1, csize >> shift);
+    active->resize(csize);
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) shadows[i]->resize(shadowSize);
+}
+
+// ------------------------------------------------------------------
+// Snapshot: the live candidate and the decision state, then the live policy's
+// snapshot followed by every shadow's
+// ------------------------------------------------------------------
+bool AdaptiveCache::save(std::ostream& out) {
+    snap_header(out, "Adaptive", csize);
+    snap_put(out, current);
+    snap_put(out, shift);
+    snap_put(out, windowSamples);
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        snap_put(out, score[i]);
+        snap_put(out, windowHits[i]);
+    }
+    if (!active->save(out)) return false;
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        if (!shadows[i]->save(out)) return false;
+    }
+    return (bool)out;
+}
+
+bool AdaptiveCache::load(std::istream& in) {
+    int candidate = 0;
+    int s = 0;
+    if (!snap_check(in, "Adaptive", csize) || !snap_get(in, candidate) || !snap_get(in, s)) return false;
+    if (candidate < 0 || candidate >= ADAPTIVE_CANDIDATES || s != shift) {
+        std::cerr << "error: snapshot holds an Adaptive cache with another sample rate" << std::endl;
+        return false;
+    }
+    if (!snap_get(in, windowSamples)) return false;
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        if (!snap_get(in, score[i]) || !snap_get(in, windowHits[i])) return false;
+    }
+    if (candidate != current) {
+        delete active;
+        active = make(candidate, csize);
+        active->setPageSize(page_size);
+        active->setEvictionSink(this);
+        current = candidate;
+        trajectory.push_back(std::make_pair(time, current));
+    }
+    if (!active->load(in)) return false;
+    for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+        if (!shadows[i]->load(in)) return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+int AdaptiveCache::refer_range(long long int offset, int length, string rwtype) {
+    // A decision can replace the live policy in the middle of a request,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+
+// ------------------------------------------------------------------
+// Remaining Required Methods
+// ------------------------------------------------------------------
+void AdaptiveCache::display() {
+	std::cout << "Adaptive Cache displayed." << std::endl;
+}
+
+void AdaptiveCache::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "policy: " << names[current] << ", switches: " << switches << ", sampled: " << sampled << std::endl;
+	std::cout<< "shadow hitRatio:";
+	for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) std::cout << " " << names[i] << " " << ((sampled > 0) ? (float)shadowHits[i] / sampled : 0.0);
+	std::cout<< std::endl << "served:";
+	for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) std::cout << " " << names[i] << " " << served[i];
+	std::cout<< std::endl << "trajectory:";
+	for (size_t i = 0; i < trajectory.size(); i++) std::cout << " " << trajectory[i].first << ":" << names[trajectory[i].second];
+	std::cout<< std::endl;
+
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result <<  "Adaptive " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " policy " << names[current] << " switches " << switches << "\n" ;
+	}
+	result.close();
+}
+
+void AdaptiveCache::refresh(){
+	calls = 0;
+	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	switches = 0;
+	sampled = 0;
+	for (int i = 0; i < ADAPTIVE_CANDIDATES; i++) {
+		served[i] = 0;
+		shadowHits[i] = 0;
+	}
+	migration = 0;
+}
+
+void AdaptiveCache::summary() {
+	// print the number of total cache calls, hits, and data migration size
+}
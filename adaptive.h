@@ -0,0 +1,129 @@
+/* adaptive.h - Adaptive meta-policy: sampled shadow caches pick the live eviction policy */
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "lru.h"
+#include "lfu.h"
+#include "lirs.h"
+#include "arc.h"
+#include "cacheus.h"
+using namespace std;
+#ifndef _adaptive_H
+#define _adaptive_H
+
+#define ADAPTIVE_CANDIDATES 5          // LRU, LFU, LIRS, ARC, CACHEUS
+#define ADAPTIVE_MAX_SHIFT 7           // shadows see at most 1 in 2^shift keys (spatial sampling)
+#define ADAPTIVE_MIN_SHADOW 64         // but each shadow keeps at least this many pages
+#define ADAPTIVE_WINDOW_SAMPLES 1024   // sampled references between two decisions
+#define ADAPTIVE_DECAY 0.5             // weight of the earlier windows in a shadow's score
+#define ADAPTIVE_MARGIN 0.05           // a candidate must beat the live policy's score by 5% to take over
+
+// The operations the meta-policy needs from a candidate, so the live policy can
+// be replaced at run time
+class PagePolicy
+{
+public:
+    virtual ~PagePolicy() {}
+    virtual bool refer(long long int, string) = 0;
+    virtual bool contains(long long int) = 0;
+    virtual bool install(long long int, string) = 0;
+    virtual bool remove(long long int) = 0;
+    virtual void setEvictionSink(EvictionSink*) = 0;
+    virtual void setPageSize(int) = 0;
+    virtual void resize(int) = 0;
+    virtual bool save(std::ostream&) = 0;
+    virtual bool load(std::istream&) = 0;
+    virtual void residents(std::vector<std::pair<long long int, bool> >&) = 0;
+};
+
+// Any page policy with the usual interface, built without its banner
+template <class Cache>
+class PolicyAdapter : public PagePolicy
+{
+private:
+    Cache cache;
+
+public:
+    PolicyAdapter(int n) : cache(n, false) {
+    }
+    bool refer(long long int x, string rwtype) { return cache.refer(x, rwtype); }
+    bool contains(long long int x) { return cache.contains(x); }
+    bool install(long long int x, string rwtype) { return cache.install(x, rwtype); }
+    bool remove(long long int x) { return cache.remove(x); }
+    void setEvictionSink(EvictionSink* s) { cache.setEvictionSink(s); }
+    void setPageSize(int n) { cache.setPageSize(n); }
+    void resize(int n) { cache.resize(n); }
+    bool save(std::ostream& out) { return cache.save(out); }
+    bool load(std::istream& in) { return cache.load(in); }
+    void residents(std::vector<std::pair<long long int, bool> >& out) { cache.residents(out); }
+};
+
+class AdaptiveCache : public EvictionSink
+{
+private:
+    int csize; // Maximum capacity of the cache
+
+    // The live policy, and one shadow per candidate. The shadows only see the keys
+    // whose hash falls in a 1/2^shift sample and are scaled down by the same factor,
+    // so each one's hit ratio estimates that candidate's at the full size.
+    PagePolicy* active;
+    int current;
+    PagePolicy* shadows[ADAPTIVE_CANDIDATES];
+    int shift;
+    int shadowSize;
+
+    // Decisions: every ADAPTIVE_WINDOW_SAMPLES sampled references each shadow's
+    // score decays and adds its hits from the window
+    double score[ADAPTIVE_CANDIDATES];
+    long long int windowHits[ADAPTIVE_CANDIDATES];
+    long long int windowSamples;
+    long long int time; // references seen, never reset
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int switches;
+    long long int served[ADAPTIVE_CANDIDATES];      // references handled by each candidate
+    long long int shadowHits[ADAPTIVE_CANDIDATES];  // sampled hits of each shadow
+    long long int sampled;                          // sampled references
+    std::vector<std::pair<long long int, int> > trajectory; // (reference, candidate) at each switch
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    int page_size; // keys are page-aligned byte addresses
+    long long int migration, total_migration;
+
+    // Helper functions for the meta-policy
+    static PagePolicy* make(int, int);
+    bool in_sample(long long int);
+    void decide();
+    void switch_to(int);
+
+public:
+    static const char* names[ADAPTIVE_CANDIDATES];
+
+    AdaptiveCache(int);
+    ~AdaptiveCache();
+    void evicted(long long int, bool); // victims of the live policy pass through here
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity of the live policy and the shadows
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+#endif
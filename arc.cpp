@@ -7,12 +7,19 @@
 #include "arc.h" 
 using namespace std; 
 
+bool ARCDefaults::compactGhosts = false;
+
 // ------------------------------------------------------------------
 // Constructor and Destructor
 // ------------------------------------------------------------------
-ARCCache::ARCCache(int n) {
+template <class Observer>
+ARCCacheT<Observer>::ARCCacheT(int n, bool verbose) : L1(arena.list()), T1(arena.list()), L2(arena.list()), T2(arena.list()), list_map(arena.map<KeyList::iterator>()), key_set_map(arena.map<ListSet>()),
+    compact(compactGhosts), T1_tags(compactGhosts ? history_cap(n) : 0, false), T2_tags(compactGhosts ? history_cap(n) : 0, false), accessType(arena.map<string>()) {
     csize = n;
     p = 0; 
+    ghostLimit = history_cap(csize);
+    trimmed = 0;
+    falseGhostHits = 0;
     
     // Initialize statistics variables
     hits = 0;	
@@ -20,13 +27,18 @@ ARCCache::ARCCache(int n) {
     readHits = 0; 
     writeHits = 0; 
     evictedDirtyPage = 0; 
+    sink = NULL;
+    page_size = PAGE_SIZE;
     
-    std::cout << "ARC Algorithm is used" << std::endl;
-	std::cout << "Cache size: " << csize << ", Initial pivot p: " << p << std::endl;
+    if (verbose) {
+        std::cout << "ARC Algorithm is used" << std::endl;
+        std::cout << "Cache size: " << csize << ", Initial pivot p: " << p << (compact ? ", Ghost lists: fingerprints" : "") << std::endl;
+    }
 }
 
 // Memory-safe Destructor
-ARCCache::~ARCCache() {
+template <class Observer>
+ARCCacheT<Observer>::~ARCCacheT() {
     L1.clear();
     T1.clear();
     L2.clear();
@@ -36,13 +48,62 @@ ARCCache::~ARCCache() {
     accessType.clear();
 }
 
+template <class Observer>
+void ARCCacheT<Observer>::setCompactGhosts(bool on) {
+    compactGhosts = on;
+}
+
 // ------------------------------------------------------------------
 // ARC Helper Function: Clean Ghost List (Helper for replace)
 // ------------------------------------------------------------------
 
-void ARCCache::clean_ghost_list(std::list<long long int>& T_list_to_check) {
-    // Ensures T1.size() + T2.size() <= C
-    while (T1.size() + T2.size() > csize) {
+template <class Observer>
+long long int ARCCacheT<Observer>::ghost_size() {
+    return compact ? T1_tags.size() + T2_tags.size() : (long long int)(T1.size() + T2.size());
+}
+
+template <class Observer>
+int ARCCacheT<Observer>::getCapacity() {
+    return csize;
+}
+
+template <class Observer>
+bool ARCCacheT<Observer>::hasCompactGhosts() {
+    return compact;
+}
+
+template <class Observer>
+long long int ARCCacheT<Observer>::getGhostBytes() {
+    return ghost_bytes();
+}
+
+template <class Observer>
+long long int ARCCacheT<Observer>::getFalseGhostHits() {
+    return falseGhostHits;
+}
+
+template <class Observer>
+long long int ARCCacheT<Observer>::ghost_bytes() {
+    if (compact) return T1_tags.bytes() + T2_tags.bytes();
+    // a list node and two map entries (list_map, key_set_map) per ghost
+    long long int entry = list_entry_bytes() + map_entry_bytes(sizeof(KeyList::iterator)) + map_entry_bytes(sizeof(ListSet));
+    return ghost_size() * entry;
+}
+
+template <class Observer>
+void ARCCacheT<Observer>::clean_ghost_list(KeyList& T_list_to_check) {
+    if (compact) {
+        // Same order on the filters: the oldest T2 entries go first
+        while (ghost_size() > ghostLimit) {
+            if (ghost_size() <= csize) trimmed++;
+            if (!T2_tags.pop() && !T1_tags.pop()) break;
+        }
+        return;
+    }
+
+    // Ensures T1.size() + T2.size() <= C (or the metadata budget)
+    while (T1.size() + T2.size() > ghostLimit) {
+        if (T1.size() + T2.size() <= csize) trimmed++;
         
         long long int victim;
         
@@ -73,11 +134,13 @@ void ARCCache::clean_ghost_list(std::list<long long int>& T_list_to_check) {
 // ARC Helper Function: Replacement logic 
 // ------------------------------------------------------------------
 
-void ARCCache::replace() {
+template <class Observer>
+void ARCCacheT<Observer>::replace() {
     long long int victim;
     
-    // Evict from L1 if L1 is larger than p 
-    if (L1.size() > p) { 
+    // Evict from L1 if L1 is larger than p, or if L2 has nothing to give
+    // (p can reach C, and a full cache must always evict something)
+    if (L1.size() > p || (L2.empty() && !L1.empty())) { 
         // L1 must not be empty here since L1.size() > p >= 0
         victim = L1.back();
         
@@ -89,14 +152,21 @@ void ARCCache::replace() {
         key_set_map.erase(victim);
         
         // 3. Add to T1 
-        T1.push_front(victim);
-        list_map[victim] = T1.begin();
-        key_set_map[victim] = T1_SET;
+        if (compact) {
+            T1_tags.insert(victim, 0);
+        } else {
+            T1.push_front(victim);
+            list_map[victim] = T1.begin();
+            key_set_map[victim] = T1_SET;
+        }
         
         // Check dirty eviction status
-        if(accessType.count(victim) && accessType.at(victim) == "Write"){
-            evictedDirtyPage++;             
+        bool dirty = (accessType.count(victim) && accessType.at(victim) == "Write");
+        if(dirty){
+            evictedDirtyPage++;
         }
+        if (sink) sink->evicted(victim, dirty);
+        observer.evict(victim, dirty);
         // Access type moves to the ghost list, but we erase it if it was dirty
         accessType.erase(victim); 
     } 
@@ -112,14 +182,21 @@ void ARCCache::replace() {
         key_set_map.erase(victim);
 
         // 3. Add to T2 
-        T2.push_front(victim);
-        list_map[victim] = T2.begin();
-        key_set_map[victim] = T2_SET;
+        if (compact) {
+            T2_tags.insert(victim, 0);
+        } else {
+            T2.push_front(victim);
+            list_map[victim] = T2.begin();
+            key_set_map[victim] = T2_SET;
+        }
         
         // Check dirty eviction status
-        if(accessType.count(victim) && accessType.at(victim) == "Write"){
-            evictedDirtyPage++;             
+        bool dirty = (accessType.count(victim) && accessType.at(victim) == "Write");
+        if(dirty){
+            evictedDirtyPage++;
         }
+        if (sink) sink->evicted(victim, dirty);
+        observer.evict(victim, dirty);
         accessType.erase(victim); 
     } else {
         // Should not happen if L1+L2 = C, but as a safety break:
@@ -133,20 +210,27 @@ void ARCCache::replace() {
 // ------------------------------------------------------------------
 // Refer Method (Core ARC Logic)
 // ------------------------------------------------------------------
-void ARCCache::refer(long long int x, string rwtype) {
+template <class Observer>
+bool ARCCacheT<Observer>::refer(long long int x, string rwtype) {
     calls++;
     
     ListSet current_set = key_set_map.count(x) ? key_set_map.at(x) : NONE;
+    if (compact && current_set == NONE) {
+        if (T1_tags.contains(x)) current_set = T1_SET;
+        else if (T2_tags.contains(x)) current_set = T2_SET;
+    }
 
     // === 1. HIT in L1 or L2 (Resident Cache Hit) ===
     if (current_set == L1_SET || current_set == L2_SET) {
         hits++;
         (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
         if (rwtype == "Write") accessType[x] = "Write";
 
         // 1. Remove from current list (L1 or L2)
         if (current_set == L1_SET) {
             L1.erase(list_map.at(x));
+            observer.promote(x);
         } else { // L2_SET
             L2.erase(list_map.at(x));
         }
@@ -155,24 +239,34 @@ void ARCCache::refer(long long int x, string rwtype) {
         L2.push_front(x);
         list_map[x] = L2.begin();
         key_set_map[x] = L2_SET;
-        return;
+        return true;
     }
     
     // === 2. HIT in T1 or T2 (Ghost List Hit - Requires Insertion) ===
     else if (current_set == T1_SET || current_set == T2_SET) {
+        observer.miss(x, rwtype);
+        observer.ghostHit(x);
         
         // ADAPTATION STEP: Adjust the pivot 'p'
         if (current_set == T1_SET) {
             p = std::min(csize, p + 1); 
-            T1.erase(list_map.at(x)); // Remove from T1 list
         } else { // T2_SET
             p = std::max(0, p - 1); 
-            T2.erase(list_map.at(x)); // Remove from T2 list
         }
-        
-        // CRITICAL: Safely remove from maps (Must happen AFTER list erase and BEFORE list re-add)
-        list_map.erase(x);
-        key_set_map.erase(x);
+
+        if (compact) {
+            if (!(current_set == T1_SET ? T1_tags : T2_tags).verify(x)) falseGhostHits++;
+            (current_set == T1_SET) ? T1_tags.erase(x) : T2_tags.erase(x);
+        } else {
+            if (current_set == T1_SET) {
+                T1.erase(list_map.at(x)); // Remove from T1 list
+            } else {
+                T2.erase(list_map.at(x)); // Remove from T2 list
+            }
+            // CRITICAL: Safely remove from maps (Must happen AFTER list erase and BEFORE list re-add)
+            list_map.erase(x);
+            key_set_map.erase(x);
+        }
 
         // Evict resident block if cache is full (L1+L2 = C)
         if (L1.size() + L2.size() == csize) {
@@ -184,17 +278,19 @@ void ARCCache::refer(long long int x, string rwtype) {
         list_map[x] = L2.begin();
         key_set_map[x] = L2_SET;
         accessType[x] = rwtype; 
+        observer.insert(x);
         clean_ghost_list(T1); 
-        return;
+        return false;
     }
     
     // === 3. MISS (New Block - Requires Insertion) ===
     else {
+        observer.miss(x, rwtype);
         // Eviction logic if we need space for the new block.
         if (L1.size() + L2.size() == csize) {
             // Cache is full, need to evict a resident block
             replace(); 
-        } else if (T1.size() + T2.size() == csize) {
+        } else if (ghost_size() >= ghostLimit) {
             // Total ghost capacity exceeded, must evict a ghost (from T2)
             clean_ghost_list(T2); 
         }
@@ -204,35 +300,242 @@ void ARCCache::refer(long long int x, string rwtype) {
         list_map[x] = L1.begin();
         key_set_map[x] = L1_SET;
         accessType[x] = rwtype; 
+        observer.insert(x);
+    }
+    return false;
+}
+
+template <class Observer>
+bool ARCCacheT<Observer>::contains(long long int x) {
+    typename KeyMap<ListSet>::iterator it = key_set_map.find(x);
+    return it != key_set_map.end() && (it->second == L1_SET || it->second == L2_SET);
+}
+
+template <class Observer>
+bool ARCCacheT<Observer>::install(long long int x, string rwtype) {
+    ListSet current_set = key_set_map.count(x) ? key_set_map.at(x) : NONE;
+    if (current_set == L1_SET || current_set == L2_SET) return false;
+    // An installed page is no evidence for either ghost list: drop the history
+    // so the page enters L1 as a new block and p is not adapted
+    if (compact) {
+        T1_tags.erase(x);
+        T2_tags.erase(x);
+    }
+    if (current_set == T1_SET) T1.erase(list_map.at(x));
+    if (current_set == T2_SET) T2.erase(list_map.at(x));
+    list_map.erase(x);
+    key_set_map.erase(x);
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool ARCCacheT<Observer>::remove(long long int x) {
+    ListSet current_set = key_set_map.count(x) ? key_set_map.at(x) : NONE;
+    if (current_set != L1_SET && current_set != L2_SET) return false;
+    // The block leaves without a ghost entry, it was not evicted by ARC
+    if (current_set == L1_SET) L1.erase(list_map.at(x));
+    else L2.erase(list_map.at(x));
+    list_map.erase(x);
+    key_set_map.erase(x);
+    bool dirty = (accessType.count(x) && accessType.at(x) == "Write");
+    accessType.erase(x);
+    return dirty;
+}
+
+template <class Observer>
+long long int ARCCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void ARCCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void ARCCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void ARCCacheT<Observer>::resize(int n) {
+    csize = n;
+    p = std::min(p, csize);
+    while (L1.size() + L2.size() > csize) {
+        replace();
+    }
+    // the ghost lists shrink with the cache
+    ghostLimit = history_cap(csize);
+    clean_ghost_list(T2);
+    if (compact) {
+        T1_tags.resize(ghostLimit);
+        T2_tags.resize(ghostLimit);
     }
 }
 
+template <class Observer>
+void ARCCacheT<Observer>::residents(std::vector<std::pair<long long int, bool> >& out) {
+    out.clear();
+    KeyList* lists[2] = {&L1, &L2};
+    for (int l = 0; l < 2; l++) {
+        for (KeyList::reverse_iterator it = lists[l]->rbegin(); it != lists[l]->rend(); it++) {
+            out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Snapshot: p, then L1, L2 (with dirty bits) and the ghost lists T1, T2, each MRU first;
+// compact ghost lists are saved as their filters
+// ------------------------------------------------------------------
+template <class Observer>
+bool ARCCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "ARC", csize);
+    snap_put(out, p);
+    snap_put(out, (uint8_t)compact);
+    KeyList* lists[4] = {&L1, &L2, &T1, &T2};
+    for (int l = 0; l < (compact ? 2 : 4); l++) {
+        snap_put(out, (long long int)lists[l]->size());
+        for (KeyList::iterator it = lists[l]->begin(); it != lists[l]->end(); it++) {
+            snap_put_entry(out, *it, accessType.count(*it) && accessType.at(*it) == "Write");
+        }
+    }
+    if (compact && (!T1_tags.save(out) || !T2_tags.save(out))) return false;
+    return (bool)out;
+}
+
+template <class Observer>
+bool ARCCacheT<Observer>::load(std::istream& in) {
+    uint8_t fingerprints = 0;
+    if (!snap_check(in, "ARC", csize) || !snap_get(in, p) || !snap_get(in, fingerprints)) return false;
+    if ((bool)fingerprints != compact) {
+        std::cerr << "error: snapshot holds ARC with " << (fingerprints ? "fingerprint" : "exact") << " ghost lists, cannot restore it into " << (compact ? "fingerprint" : "exact") << " ones" << std::endl;
+        return false;
+    }
+    L1.clear();
+    L2.clear();
+    T1.clear();
+    T2.clear();
+    list_map.clear();
+    key_set_map.clear();
+    accessType.clear();
+    KeyList* lists[4] = {&L1, &L2, &T1, &T2};
+    ListSet sets[4] = {L1_SET, L2_SET, T1_SET, T2_SET};
+    for (int l = 0; l < (compact ? 2 : 4); l++) {
+        long long int n = 0;
+        if (!snap_get(in, n)) return false;
+        for (long long int i = 0; i < n; i++) {
+            long long int x;
+            bool dirty;
+            if (!snap_get_entry(in, x, dirty)) return false;
+            lists[l]->push_back(x);
+            list_map[x] = --lists[l]->end();
+            key_set_map[x] = sets[l];
+            // ghost entries hold no data, only resident blocks carry an access type
+            if (l < 2) accessType[x] = dirty ? "Write" : "Read";
+        }
+    }
+    if (compact && (!T1_tags.load(in) || !T2_tags.load(in))) return false;
+    // a snapshot taken without the budget is trimmed to it
+    clean_ghost_list(T2);
+    return true;
+}
+
+// Batched references: the lookups of the whole batch are issued before the first update,
+// so their cache misses overlap instead of each one stalling the next; the updates then
+// run in order through refer(), so the result is that of referring the keys one by one.
+template <class Observer>
+void ARCCacheT<Observer>::prefetch(const long long int* keys, int n) {
+    if (list_map.size() < PREFETCH_MIN_KEYS) return;
+    prefetch_buckets(key_set_map, keys, n, batch_buckets);
+    prefetch_buckets(list_map, keys, n, batch_buckets);
+    prefetch_buckets(accessType, keys, n, batch_buckets);
+    for (int i = 0; i < n; i++) {
+        KeyMap<KeyList::iterator>::const_iterator it = list_map.find(keys[i]);
+        // the list node is moved on a hit
+        if (it != list_map.end()) __builtin_prefetch(&*it->second, 1);
+    }
+}
+
+template <class Observer>
+int ARCCacheT<Observer>::refer_batch(const long long int* keys, const string* ops, int n, char* hit, long long int* dirty) {
+    prefetch(keys, n);
+    int hitKeys = 0;
+    for (int i = 0; i < n; i++) {
+        long long int before = evictedDirtyPage;
+        bool h = refer(keys[i], ops[i]);
+        if (hit) hit[i] = h;
+        if (dirty) dirty[i] = evictedDirtyPage - before;
+        hitKeys += h;
+    }
+    return hitKeys;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int ARCCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Ghost-list transitions of earlier pages can move later pages of the run,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
 
 // ------------------------------------------------------------------
 // Remaining Required Methods
 // ------------------------------------------------------------------
-void ARCCache::display() {
+template <class Observer>
+void ARCCacheT<Observer>::display() {
 	std::cout << "ARC Cache displayed." << std::endl;
 }
 
-void ARCCache::cachehits() {
+template <class Observer>
+void ARCCacheT<Observer>::cachehits() {
     float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
 
 	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "ghosts: " << ghost_size() << (compact ? " (fingerprints)" : "") << ", ghostBytes: " << ghost_bytes();
+	if (compact) std::cout << ", falseGhostHits: " << falseGhostHits;
+	std::cout << std::endl;
 
 	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
 	if (result.is_open()) { 
-		result <<  "ARC " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << "\n" ;			
+		result <<  "ARC " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " ghosts " << ghost_size() << " ghostBytes " << ghost_bytes();
+		if (compact) result << " falseGhostHits " << falseGhostHits;
+		result << "\n";
 	}
 	result.close();
+	report_budget("ARC", ghost_size(), trimmed);
 }
 
-void ARCCache::refresh(){
+template <class Observer>
+void ARCCacheT<Observer>::refresh(){
 	calls = 0;
 	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	trimmed = 0;
+	falseGhostHits = 0;
 	migration = 0;
 }
 
-void ARCCache::summary() {
+template <class Observer>
+void ARCCacheT<Observer>::summary() {
 	// print the number of total cache calls, hits, and data migration size
-}
\ No newline at end of file
+}
+
+// The observers the simulator is built with (observer.h)
+template class ARCCacheT<NullObserver>;
+template class ARCCacheT<EventRecorder>;
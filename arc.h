@@ -3,53 +3,106 @@
 #include <unordered_map>
 #include <list>
 #include <algorithm>
+#include <vector>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "arena.h"
+#include "ghost.h"
+#include "budget.h"
 using namespace std; 
 #ifndef _arc_H
 #define _arc_H
 
-class ARCCache
+// Shared by every ARCCacheT, whatever its observer
+struct ARCDefaults
+{
+    static bool compactGhosts; // default for new caches (command line -g)
+};
+
+template <class Observer = NullObserver>
+class ARCCacheT : private ARCDefaults
 {
 private:
+    // backs the lists and maps below when -G is given (arena.h)
+    MetadataArena arena;
+
     int csize; // Maximum capacity of the cache (C)
     int p;     // The 'pivot' or target size for the L1/T1 lists (0 <= p <= C)
 
     // L1: List of recently referenced pages not seen before (L1 is an LRU list)
-    std::list<long long int> L1; 
+    KeyList L1; 
     // T1: Ghost list corresponding to L1 (history of L1 pages)
-    std::list<long long int> T1;
+    KeyList T1;
 
     // L2: List of frequently referenced pages (L2 is an LRU list)
-    std::list<long long int> L2;
+    KeyList L2;
     // T2: Ghost list corresponding to L2 (history of L2 pages)
-    std::list<long long int> T2;
+    KeyList T2;
     
     // Maps key to iterator in its respective list (L1, T1, L2, or T2)
-    std::unordered_map<long long int, std::list<long long int>::iterator> list_map;
+    KeyMap<KeyList::iterator> list_map;
 
     // Maps key to its current list/set (e.g., '1' for L1, '2' for L2, etc.)
     enum ListSet {NONE, L1_SET, T1_SET, L2_SET, T2_SET};
-    std::unordered_map<long long int, ListSet> key_set_map;
+    KeyMap<ListSet> key_set_map;
+
+    // Compact mode: T1 and T2 are fingerprint filters instead of the lists above,
+    // and the maps hold resident blocks only
+    bool compact;
+    GhostFilter T1_tags;
+    GhostFilter T2_tags;
+    long long int ghostLimit;  // T1 + T2 entries: C, or the metadata budget if smaller
+    long long int trimmed;     // ghosts dropped because of the budget
+    long long int falseGhostHits; // filter matches left by another key, taken for ghost hits
 
     // Statistics (Similar to LRU/LFU)
-    std::unordered_map<long long int, string> accessType; 
+    KeyMap<string> accessType; 
     long long int calls, total_calls;
     long long int hits, total_hits;
     long long int readHits; 
     long long int writeHits; 
     long long int evictedDirtyPage; 
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
     long long int migration, total_migration;
 
     // Helper functions for the ARC policy
+    std::vector<size_t> batch_buckets; // scratch space for prefetch: each key's bucket
+
     void replace(); // <-- CORRECTED DECLARATION
-    void clean_ghost_list(std::list<long long int>& T_list_to_check);
+    void clean_ghost_list(KeyList& T_list_to_check);
+    long long int ghost_size();
+    long long int ghost_bytes();
     
 public:
-    ARCCache(int);
-    ~ARCCache();
-    void refer(long long int, string);
+    ARCCacheT(int, bool verbose = true);
+    ~ARCCacheT();
+    static void setCompactGhosts(bool); // fingerprint ghost lists for caches created afterwards
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    void prefetch(const long long int*, int); // brings the metadata of these keys into the CPU cache, changes nothing
+    int refer_batch(const long long int*, const string*, int, char* hit = NULL, long long int* dirty = NULL); // refer each key in order after prefetching them all, returns the hits; dirty: dirty victims per key
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    int getCapacity();
+    bool hasCompactGhosts();
+    long long int getGhostBytes();
+    long long int getFalseGhostHits();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts ARC's own replacement order
+    void residents(std::vector<std::pair<long long int, bool> >&); // resident keys and dirty bits, L1 then L2, each LRU first
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
     void display();
     void cachehits();
     void refresh();
     void summary();
 };
-#endif
\ No newline at end of file
+
+typedef ARCCacheT<> ARCCache;
+#endif
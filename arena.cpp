@@ -0,0 +1,204 @@
+/* arena.cpp - Metadata arena Implementation */
+
+#include <sys/mman.h>
+#include <stdint.h>
+#include <new>
+#include <atomic>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "arena.h"
+using namespace std;
+
+struct ArenaFreeBlock {
+    ArenaFreeBlock* next;
+};
+
+static HugePageMode mode = HUGE_PAGES_OFF;
+static bool reporting = false;
+
+// Statistics, over every arena: the first three are what is mapped now, the rest
+// totals since the start that unmapping does not lower
+static std::atomic<long long int> mappedChunks(0);
+static std::atomic<long long int> mappedChunkBytes(0);
+static std::atomic<long long int> largeBytes(0);     // mapped for large blocks
+static std::atomic<long long int> explicitBytes(0);  // ever mapped from the huge page pool
+static std::atomic<long long int> advisedBytes(0);   // ever mapped with MADV_HUGEPAGE
+static std::atomic<long long int> fallbacks(0);      // mappings that got smaller pages than asked for
+
+void arena_set_huge_pages(HugePageMode m) {
+    mode = m;
+    reporting = true;
+}
+
+HugePageMode arena_huge_pages() {
+    return mode;
+}
+
+bool arena_reporting() {
+    return reporting;
+}
+
+// ------------------------------------------------------------------
+// Mappings
+// ------------------------------------------------------------------
+// Length of the mapping for a block of the given size; only depends on the mode,
+// so a large block is unmapped with the length it was mapped with
+static size_t mapping_length(size_t bytes) {
+    size_t unit = (mode == HUGE_PAGES_OFF) ? 4096 : ARENA_HUGE_PAGE;
+    return (bytes + unit - 1) / unit * unit;
+}
+
+// Maps len bytes (a multiple of the huge page unless the mode is off) backed the
+// way the mode asks, falling back to smaller pages; NULL if there is no memory
+static void* map_region(size_t len) {
+#ifdef MAP_HUGETLB
+    if (mode == HUGE_PAGES_EXPLICIT) {
+        void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            explicitBytes += len;
+            return p;
+        }
+        // the pool (vm.nr_hugepages) is empty or too small
+        fallbacks++;
+    }
+#endif
+    if (mode == HUGE_PAGES_OFF) {
+        void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return (p == MAP_FAILED) ? NULL : p;
+    }
+
+    // a transparent huge page needs a 2MB aligned range: map one more and trim both ends
+    char* raw = (char*)mmap(NULL, len + ARENA_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char* p = (char*)(((uintptr_t)raw + ARENA_HUGE_PAGE - 1) & ~(uintptr_t)(ARENA_HUGE_PAGE - 1));
+    if (p > raw) munmap(raw, p - raw);
+    munmap(p + len, raw + ARENA_HUGE_PAGE - p);
+#ifdef MADV_HUGEPAGE
+    if (madvise(p, len, MADV_HUGEPAGE) == 0) {
+        advisedBytes += len;
+        return p;
+    }
+#endif
+    // THP is compiled out or disabled (/sys/kernel/mm/transparent_hugepage/enabled = never)
+    fallbacks++;
+    return p;
+}
+
+// ------------------------------------------------------------------
+// Allocation
+// ------------------------------------------------------------------
+static int size_class(size_t bytes) {
+    if (bytes <= ARENA_SMALL) return (bytes == 0) ? 0 : (int)((bytes - 1) / 16);
+    int c = ARENA_SMALL / 16;
+    size_t size = 2 * ARENA_SMALL;
+    while (size < bytes) {
+        size <<= 1;
+        c++;
+    }
+    return c;
+}
+
+static size_t class_size(int c) {
+    if (c < ARENA_SMALL / 16) return (size_t)(c + 1) * 16;
+    return (size_t)(2 * ARENA_SMALL) << (c - ARENA_SMALL / 16);
+}
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+Arena::Arena() {
+    next = NULL;
+    end = NULL;
+    for (int c = 0; c < ARENA_CLASSES; c++) free[c] = NULL;
+    chunkBytes = ARENA_HUGE_PAGE;
+}
+
+Arena::~Arena() {
+    // the cache's containers are gone; large blocks were unmapped when they were freed
+    for (size_t i = 0; i < chunks.size(); i++) {
+        munmap(chunks[i].first, chunks[i].second);
+        mappedChunks--;
+        mappedChunkBytes -= chunks[i].second;
+    }
+    chunks.clear();
+}
+
+void* Arena::allocate(size_t bytes) {
+    if (bytes > ARENA_LARGE) {
+        void* p = map_region(mapping_length(bytes));
+        if (!p) throw std::bad_alloc();
+        largeBytes += mapping_length(bytes);
+        return p;
+    }
+    int c = size_class(bytes);
+    ArenaFreeBlock* b = free[c];
+    if (b) {
+        free[c] = b->next;
+        return b;
+    }
+    size_t size = class_size(c);
+    if ((size_t)(end - next) < size) {
+        // the rest of the old chunk (under 64KB) is left unused; small caches stay in
+        // one huge page, large ones soon map ARENA_CHUNK at a time
+        char* chunk = (char*)map_region(chunkBytes);
+        if (!chunk) throw std::bad_alloc();
+        chunks.push_back(std::make_pair(chunk, chunkBytes));
+        mappedChunks++;
+        mappedChunkBytes += chunkBytes;
+        next = chunk;
+        end = chunk + chunkBytes;
+        chunkBytes = min(2 * chunkBytes, (size_t)ARENA_CHUNK);
+    }
+    void* p = next;
+    next += size;
+    return p;
+}
+
+void Arena::deallocate(void* p, size_t bytes) {
+    if (!p) return;
+    if (bytes > ARENA_LARGE) {
+        munmap(p, mapping_length(bytes));
+        largeBytes -= mapping_length(bytes);
+        return;
+    }
+    int c = size_class(bytes);
+    ArenaFreeBlock* b = (ArenaFreeBlock*)p;
+    b->next = free[c];
+    free[c] = b;
+}
+
+// ------------------------------------------------------------------
+// Report
+// ------------------------------------------------------------------
+// The kernel's count of this process's anonymous memory in transparent huge pages, -1 if unknown
+static long long int anon_huge_bytes() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    string line;
+    while (getline(in, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            std::istringstream fields(line.substr(14));
+            long long int kb = -1;
+            fields >> kb;
+            return (kb < 0) ? -1 : kb * 1024;
+        }
+    }
+    return -1;
+}
+
+void arena_report(const string& policy, long long int requests, double seconds) {
+    if (!reporting) return;
+    static const char* names[] = {"off", "transparent", "explicit"};
+    long long int mapped = mappedChunkBytes + largeBytes;
+    long long int huge = anon_huge_bytes();
+    double throughput = (seconds > 0) ? requests / seconds : 0;
+    std::cout << "metadata arena: huge pages " << names[mode] << ", mapped now(MB): " << (mapped >> 20) << " in " << mappedChunks << " chunks + " << (largeBytes >> 20) << " large; since the start, explicit(MB): " << (explicitBytes >> 20) << ", advised(MB): " << (advisedBytes >> 20) << ", fallbacks: " << fallbacks;
+    if (huge >= 0) std::cout << ", AnonHugePages(MB): " << (huge >> 20);
+    std::cout << ", requests/s: " << (long long int)throughput << std::endl;
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << policy << " hugePages " << names[mode] << " arenaMappedMB " << (mapped >> 20) << " explicitTotalMB " << (explicitBytes >> 20) << " advisedTotalMB " << (advisedBytes >> 20) << " anonHugeMB " << (huge >> 20) << " hugePageFallbacks " << fallbacks << " requestsPerSecond " << (long long int)throughput << "\n";
+    }
+    result.close();
+}
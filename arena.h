@@ -0,0 +1,137 @@
+/* arena.h - Metadata arena: policy list, map and set nodes carved from large chunks that can be backed by 2MB huge pages */
+#include <stddef.h>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <string>
+#include <vector>
+#include <utility>
+#include <new>
+using namespace std;
+#ifndef _arena_H
+#define _arena_H
+
+#define ARENA_CHUNK (64LL << 20)     // largest chunk an arena maps at a time, a multiple of the huge page
+#define ARENA_HUGE_PAGE (2LL << 20)  // x86-64 and arm64 (4KB granule) huge page; an arena's first chunk
+#define ARENA_LARGE (64 << 10)       // larger blocks (hash bucket arrays) get a mapping of their own
+
+// Size classes: 16-byte steps up to 256 bytes (list, set and map nodes), then
+// powers of two from 512 bytes up to ARENA_LARGE
+#define ARENA_SMALL 256
+#define ARENA_CLASSES (ARENA_SMALL / 16 + 8)
+
+// How the arena's mappings are backed (command line -G)
+enum HugePageMode {
+    HUGE_PAGES_OFF,         // ordinary 4KB pages
+    HUGE_PAGES_TRANSPARENT, // madvise(MADV_HUGEPAGE): the kernel backs what it can with 2MB pages
+    HUGE_PAGES_EXPLICIT     // MAP_HUGETLB from the reserved pool, transparent when the pool runs dry
+};
+
+// Set once, before the first cache is built. It also turns the arenas on: without -G
+// the policies' containers use the standard allocator.
+void arena_set_huge_pages(HugePageMode);
+HugePageMode arena_huge_pages();
+bool arena_reporting(); // -G was given
+
+// The metadata of one cache. Blocks are kept in free lists by size class and reused,
+// chunks start at one huge page and double up to ARENA_CHUNK, and all of them are
+// unmapped when the arena is destroyed with its cache. An arena is not locked: a
+// cache, and so its arena, is used by one thread at a time (partitioned replay builds
+// and destroys the shards' caches on the main thread, a worker replays each).
+struct ArenaFreeBlock;
+
+class Arena
+{
+private:
+    char* next; // bump pointer into the current chunk
+    char* end;
+    ArenaFreeBlock* free[ARENA_CLASSES];
+    std::vector<std::pair<char*, size_t> > chunks;
+    size_t chunkBytes; // length of the next chunk
+
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+
+public:
+    Arena();
+    ~Arena();
+    void* allocate(size_t);
+    void deallocate(void*, size_t);
+};
+
+// One line on the arenas' mappings, their backing and the replay throughput, when -G is given
+void arena_report(const string& policy, long long int requests, double seconds);
+
+// Standard allocator over a cache's arena, or over the heap when there is none
+template <class T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+    Arena* arena;
+
+    ArenaAllocator(Arena* a = NULL) : arena(a) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena ? arena->allocate(n * sizeof(T)) : ::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) {
+        if (arena) arena->deallocate(p, n * sizeof(T));
+        else ::operator delete(p);
+    }
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+// The containers the policies keep their per-page metadata in
+typedef std::list<long long int, ArenaAllocator<long long int> > KeyList;
+typedef std::set<long long int, std::less<long long int>, ArenaAllocator<long long int> > KeySet;
+template <class V>
+using KeyMap = std::unordered_map<long long int, V, std::hash<long long int>, std::equal_to<long long int>, ArenaAllocator<std::pair<const long long int, V> > >;
+
+// Tables of fewer keys stay in the CPU caches, prefetching them only costs instructions
+#define PREFETCH_MIN_KEYS (1 << 16)
+
+// Batched lookups (-k), first half: hash every key to its bucket, which reads nothing
+// from the table, then prefetch the first node of each bucket. Within one key the loads
+// are a chain (begin() reads the bucket slot, then the node before the bucket's first),
+// but the chains of different keys do not depend on each other, so the processor can
+// run several at once where a find() per key, followed by its update, runs them one
+// after another. The finds that follow mostly hit cached buckets.
+template <class V>
+void prefetch_buckets(const KeyMap<V>& m, const long long int* keys, int n, std::vector<size_t>& buckets) {
+    buckets.resize(n);
+    for (int i = 0; i < n; i++) buckets[i] = m.bucket(keys[i]);
+    for (int i = 0; i < n; i++) {
+        typename KeyMap<V>::const_local_iterator it = m.begin(buckets[i]);
+        if (it != m.end(buckets[i])) __builtin_prefetch(&*it, 1);
+    }
+}
+
+// A policy's arena, when -G asked for one, and its empty containers. Declared before
+// the containers built from it, so they are destroyed first.
+class MetadataArena
+{
+private:
+    Arena* arena;
+
+    MetadataArena(const MetadataArena&);
+    MetadataArena& operator=(const MetadataArena&);
+
+public:
+    MetadataArena() : arena(arena_reporting() ? new Arena() : NULL) {}
+    ~MetadataArena() { delete arena; }
+
+    KeyList list() const { return KeyList(ArenaAllocator<long long int>(arena)); }
+    KeySet set() const { return KeySet(std::less<long long int>(), ArenaAllocator<long long int>(arena)); }
+    template <class V>
+    KeyMap<V> map() const {
+        return KeyMap<V>(0, std::hash<long long int>(), std::equal_to<long long int>(), ArenaAllocator<std::pair<const long long int, V> >(arena));
+    }
+};
+#endif
@@ -0,0 +1,39 @@
+/* budget.h - Metadata budget: a hard cap on the history (non-resident keys) each cache remembers */
+#include <iostream>
+#include <fstream>
+using namespace std;
+#ifndef _budget_H
+#define _budget_H
+
+// History entries each cache instance may keep (ghost lists, non-resident LIRS
+// blocks, MQ's Qout, LeCaR's expert histories, S3-FIFO's ghost FIFO, outstanding
+// prefetches). 0 leaves every policy at its own bound (command line -M).
+inline long long int& metadata_budget() {
+    static long long int entries = 0;
+    return entries;
+}
+
+// A policy's history bound under the budget: its own bound, or the budget if
+// that is smaller (never below one entry, so every history keeps working)
+inline long long int history_cap(long long int natural) {
+    long long int budget = metadata_budget();
+    if (budget <= 0 || budget >= natural) return natural;
+    return budget;
+}
+
+// One line in the policy report, only when a budget is set; trimmed counts the
+// history entries dropped because of the budget, which the policy would otherwise
+// have remembered, so a nonzero count means the cap changed the results
+inline void report_budget(const char* policy, long long int history, long long int trimmed) {
+    long long int budget = metadata_budget();
+    if (budget <= 0) return;
+    std::cout << "metadata budget: " << budget << " history entries, held: " << history << ", trimmed: " << trimmed;
+    if (trimmed > 0) std::cout << " (the cap changed " << policy << "'s decisions)";
+    std::cout << std::endl;
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << policy << " metadataBudget " << budget << " history " << history << " historyTrimmed " << trimmed << "\n";
+    }
+    result.close();
+}
+#endif
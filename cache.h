@@ -0,0 +1,188 @@
+/* cache.h - Key-value cache: a page policy's eviction order over real keys and values */
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <tuple>
+#include <new>
+#include <type_traits>
+#include "evictsink.h"
+#include "lru.h"
+#include "lfu.h"
+#include "lirs.h"
+#include "arc.h"
+#include "cacheus.h"
+using namespace std;
+#ifndef _cache_H
+#define _cache_H
+
+// Holds up to capacity values and lets Policy (LRUCache, LFUCache, LIRSCache,
+// ARCCache, CACHEUSCache, or any of them built with an observer) decide which one
+// leaves. The policy is the simulator's own class and tracks 64-bit keys: a key is
+// known to it by its hash, and a key whose hash a resident key already holds is
+// given the next free id instead, so two resident keys never share a slot.
+//
+// get() is a read of a resident key; a miss is not a reference, it only becomes one
+// when the caller puts the value, so a policy with history (ARC, LIRS, CACHEUS)
+// sees the usual miss-then-insert and its ghost hits. As with fingerprint ghosts
+// (-g), a key whose hash equals an evicted key's may be taken for its ghost.
+//
+// Values may be move-only, or neither copyable nor movable when they are built with
+// emplace(). A pointer from get() stays valid until the next put, emplace or erase,
+// any of which may evict it.
+template <class Key, class Value, class Hash = std::hash<Key>, class Policy = LRUCache>
+class Cache : private EvictionSink
+{
+private:
+    // The value is constructed and destroyed by hand, so a replacement is built in the
+    // same place without moving or assigning it
+    struct Entry {
+        long long int id; // the key's name in the policy
+        bool live;
+        typename std::aligned_storage<sizeof(Value), std::alignment_of<Value>::value>::type storage;
+
+        Entry(long long int i) : id(i), live(false) {}
+        ~Entry() { destroy(); }
+        Value& value() { return *reinterpret_cast<Value*>(&storage); }
+        template <class... Args>
+        void construct(Args&&... args) {
+            new (&storage) Value(std::forward<Args>(args)...);
+            live = true;
+        }
+        void destroy() {
+            if (live) value().~Value();
+            live = false;
+        }
+    };
+    typedef std::unordered_map<Key, Entry, Hash> EntryMap;
+    typedef typename EntryMap::value_type Slot;
+
+    Policy policy;
+    Hash hash;
+    int csize;
+    EntryMap entries;
+    std::unordered_map<long long int, Slot*> byId; // resident keys by id, the policy's victims come back by id
+
+    std::function<void(const Key&, Value&)> onEvict;
+
+    // Statistics
+    long long int hits;
+    long long int misses;
+    long long int evictions;
+
+    Cache(const Cache&);
+    Cache& operator=(const Cache&);
+
+    // The key's hash, or the next id along its probe sequence that no resident key holds
+    long long int idOf(const Key& k) {
+        unsigned long long int id = (unsigned long long int)hash(k);
+        while (byId.count((long long int)id)) id = id * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (long long int)id;
+    }
+
+    // Drops a slot the policy no longer holds (or never admitted)
+    void drop(Slot* s) {
+        byId.erase(s->second.id);
+        // by iterator: s->first lives in the node being erased
+        entries.erase(entries.find(s->first));
+    }
+
+    // The policy's victim: hand the value to the callback, then drop it
+    void evicted(long long int x, bool /*dirty*/) {
+        typename std::unordered_map<long long int, Slot*>::iterator it = byId.find(x);
+        if (it == byId.end()) return;
+        Slot* s = it->second;
+        evictions++;
+        if (onEvict) onEvict(s->first, s->second.value());
+        drop(s);
+    }
+
+public:
+    Cache(int capacity) : policy(capacity, false), csize(capacity), hits(0), misses(0), evictions(0) {
+        policy.setEvictionSink(this);
+        entries.reserve(capacity);
+        byId.reserve(capacity);
+    }
+
+    // Called with every value the policy evicts, before it is destroyed; the
+    // callback may move it out. Not called for erase().
+    void setEvictionCallback(std::function<void(const Key&, Value&)> callback) {
+        onEvict = callback;
+    }
+
+    // The value of k, or NULL if it is not cached; a hit counts as a reference
+    Value* get(const Key& k) {
+        typename EntryMap::iterator it = entries.find(k);
+        if (it == entries.end()) {
+            misses++;
+            return NULL;
+        }
+        hits++;
+        policy.refer(it->second.id, "Read");
+        return &it->second.value();
+    }
+
+    // Constructs the value of k in place from args, replacing any value it had.
+    // Returns false if the policy did not admit the key. If the value's constructor
+    // throws, k is left out of the cache and the policy, and the exception propagates.
+    template <class... Args>
+    bool emplace(const Key& k, Args&&... args) {
+        typename EntryMap::iterator it = entries.find(k);
+        if (it != entries.end()) {
+            // a hit on a resident key evicts nothing
+            Slot* s = &*it;
+            policy.refer(s->second.id, "Read");
+            s->second.destroy();
+            try {
+                s->second.construct(std::forward<Args>(args)...);
+            } catch (...) {
+                policy.remove(s->second.id);
+                drop(s);
+                throw;
+            }
+            return true;
+        }
+
+        // the value exists before the policy hears of the key
+        long long int id = idOf(k);
+        Slot* s = &*entries.emplace(std::piecewise_construct, std::forward_as_tuple(k), std::forward_as_tuple(id)).first;
+        try {
+            s->second.construct(std::forward<Args>(args)...);
+        } catch (...) {
+            entries.erase(k);
+            throw;
+        }
+        byId[id] = s;
+        // the reference may evict other keys, never the one being put
+        policy.refer(id, "Read");
+        if (!policy.contains(id)) {
+            drop(s);
+            return false;
+        }
+        return true;
+    }
+
+    bool put(const Key& k, Value v) {
+        return emplace(k, std::move(v));
+    }
+
+    // Drops k without calling the eviction callback, returns false if it was not cached
+    bool erase(const Key& k) {
+        typename EntryMap::iterator it = entries.find(k);
+        if (it == entries.end()) return false;
+        policy.remove(it->second.id);
+        drop(&*it);
+        return true;
+    }
+
+    bool contains(const Key& k) const {
+        return entries.count(k) > 0;
+    }
+
+    size_t size() const { return entries.size(); }
+    int capacity() const { return csize; }
+    long long int hitCount() const { return hits; }
+    long long int missCount() const { return misses; }
+    long long int evictionCount() const { return evictions; }
+};
+#endif
@@ -10,11 +10,14 @@ using namespace std;
 // ------------------------------------------------------------------
 // Constructor and Destructor
 // ------------------------------------------------------------------
-CACHEUSCache::CACHEUSCache(int n) {
+template <class Observer>
+CACHEUSCacheT<Observer>::CACHEUSCacheT(int n, bool verbose) : Read_List(arena.list()), Write_List(arena.list()), list_map(arena.map<KeyList::iterator>()), key_segment_map(arena.map<Segment>()), accessType(arena.map<string>()) {
     csize = n;
     // Initialize segments: Start with a bias toward reads (90/10 split), 
     // which is safer than 0/1. If csize=1, this is 1/0, which must be handled.
-    write_segment_size = max(1, (int)(csize * 0.1)); 
+    // Auto-tuning moves the split at run time (see tuner.h).
+    write_share = 0.1;
+    write_segment_size = max(1, (int)(csize * write_share)); 
     read_segment_size = csize - write_segment_size;
     
     // Ensure that if csize is small (e.g., 1), read_segment_size is at least 0.
@@ -26,13 +29,18 @@ CACHEUSCache::CACHEUSCache(int n) {
     readHits = 0; 
     writeHits = 0; 
     evictedDirtyPage = 0; 
+    sink = NULL;
+    page_size = PAGE_SIZE;
     
-    std::cout << "CACHEUS Algorithm is used" << std::endl;
-	std::cout << "Cache size: " << csize << ", Read Segment Size: " << read_segment_size << ", Write Segment Size: " << write_segment_size << std::endl;
+    if (verbose) {
+        std::cout << "CACHEUS Algorithm is used" << std::endl;
+        std::cout << "Cache size: " << csize << ", Read Segment Size: " << read_segment_size << ", Write Segment Size: " << write_segment_size << std::endl;
+    }
 }
 
 // Memory-safe Destructor
-CACHEUSCache::~CACHEUSCache() {
+template <class Observer>
+CACHEUSCacheT<Observer>::~CACHEUSCacheT() {
     Read_List.clear();
     Write_List.clear();
     list_map.clear();
@@ -45,7 +53,8 @@ CACHEUSCache::~CACHEUSCache() {
 // CACHEUS Helper Functions (Eviction and Adaptation)
 // ------------------------------------------------------------------
 
-void CACHEUSCache::evict_read() {
+template <class Observer>
+void CACHEUSCacheT<Observer>::evict_read() {
     if (Read_List.empty()) return; // Critical safety check
 
     // Evict the LRU block from the Read Segment
@@ -56,13 +65,17 @@ void CACHEUSCache::evict_read() {
     key_segment_map.erase(victim);
     
     // Check dirty status upon eviction 
-    if(accessType.count(victim) && accessType.at(victim) == "Write"){
-        evictedDirtyPage++;             
+    bool dirty = (accessType.count(victim) && accessType.at(victim) == "Write");
+    if(dirty){
+        evictedDirtyPage++;
     }
+    if (sink) sink->evicted(victim, dirty);
+    observer.evict(victim, dirty);
     accessType.erase(victim);
 }
 
-void CACHEUSCache::evict_write() {
+template <class Observer>
+void CACHEUSCacheT<Observer>::evict_write() {
     if (Write_List.empty()) return; // Critical safety check
 
     // Evict the LRU block from the Write Segment
@@ -73,13 +86,44 @@ void CACHEUSCache::evict_write() {
     key_segment_map.erase(victim);
 
     // Write segment blocks are often dirty, so check and count
-    if(accessType.count(victim) && accessType.at(victim) == "Write"){
-        evictedDirtyPage++;             
+    bool dirty = (accessType.count(victim) && accessType.at(victim) == "Write");
+    if(dirty){
+        evictedDirtyPage++;
     }
+    if (sink) sink->evicted(victim, dirty);
+    observer.evict(victim, dirty);
     accessType.erase(victim);
 }
 
-void CACHEUSCache::adapt_segments() {
+template <class Observer>
+bool CACHEUSCacheT<Observer>::evict() {
+    bool evicting_read = false;
+    
+    // Priority 1: Evict from the segment that exceeds its target size AND is not empty
+    if (Read_List.size() > read_segment_size && !Read_List.empty()) {
+        evicting_read = true;
+    } else if (Write_List.size() > write_segment_size && !Write_List.empty()) {
+        evicting_read = false;
+    } 
+    // Priority 2: If neither exceeds target, find the viable LRU (prefer Read segment as victim)
+    else if (!Read_List.empty()) {
+        evicting_read = true;
+    } else if (!Write_List.empty()) {
+        evicting_read = false;
+    } else {
+        return false;
+    }
+
+    if (evicting_read) {
+        evict_read();
+    } else {
+        evict_write();
+    }
+    return true;
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::adapt_segments() {
     // Placeholder for complex adaptive logic. 
     // This is where read_segment_size and write_segment_size would be adjusted.
     // We leave this empty to prevent complexity causing more bugs.
@@ -88,7 +132,8 @@ void CACHEUSCache::adapt_segments() {
 // ------------------------------------------------------------------
 // Refer Method (Core CACHEUS Logic)
 // ------------------------------------------------------------------
-void CACHEUSCache::refer(long long int x, string rwtype) {
+template <class Observer>
+bool CACHEUSCacheT<Observer>::refer(long long int x, string rwtype) {
     calls++;
     
     Segment current_segment = key_segment_map.count(x) ? key_segment_map.at(x) : NONE;
@@ -97,6 +142,7 @@ void CACHEUSCache::refer(long long int x, string rwtype) {
     if (current_segment != NONE) {
         hits++;
         (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
         
         // Remove from current list
         if (current_segment == READ) {
@@ -116,6 +162,7 @@ void CACHEUSCache::refer(long long int x, string rwtype) {
             list_map[x] = Read_List.begin();
         } else { // Write hit
             // Write hit: stays/promotes to MRU of Write Segment
+            if (current_segment == READ) observer.promote(x);
             Write_List.push_front(x);
             key_segment_map[x] = WRITE;
             accessType[x] = "Write"; // Mark as dirty
@@ -124,36 +171,17 @@ void CACHEUSCache::refer(long long int x, string rwtype) {
         
         // If the block moved segments, the old list will shrink, potentially requiring adaptation/eviction.
         adapt_segments();
-        return;
+        return true;
     }
     
     // --- 2. MISS ---
     else {
+        observer.miss(x, rwtype);
         // --- EVICTION (Only if cache is full) ---
         if (Read_List.size() + Write_List.size() == csize) {
-            
-            bool evicting_read = false;
-            
-            // Priority 1: Evict from the segment that exceeds its target size AND is not empty
-            if (Read_List.size() > read_segment_size && !Read_List.empty()) {
-                evicting_read = true;
-            } else if (Write_List.size() > write_segment_size && !Write_List.empty()) {
-                evicting_read = false;
-            } 
-            // Priority 2: If neither exceeds target, find the viable LRU (prefer Read segment as victim)
-            else if (!Read_List.empty()) {
-                evicting_read = true;
-            } else if (!Write_List.empty()) {
-                evicting_read = false;
-            } else {
+            if (!evict()) {
                 // Should only happen if csize=0, but included for safety.
-                return; 
-            }
-
-            if (evicting_read) {
-                evict_read();
-            } else {
-                evict_write();
+                return false; 
             }
         }
         
@@ -170,20 +198,190 @@ void CACHEUSCache::refer(long long int x, string rwtype) {
             list_map[x] = Write_List.begin();
             accessType[x] = "Write"; // Mark as dirty immediately
         }
+        observer.insert(x);
 
         adapt_segments(); // Recheck segment sizes after insertion
     }
+    return false;
+}
+
+template <class Observer>
+bool CACHEUSCacheT<Observer>::contains(long long int x) {
+    return key_segment_map.count(x) > 0;
+}
+
+template <class Observer>
+bool CACHEUSCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool CACHEUSCacheT<Observer>::remove(long long int x) {
+    Segment current_segment = key_segment_map.count(x) ? key_segment_map.at(x) : NONE;
+    if (current_segment == NONE) return false;
+    if (current_segment == READ) Read_List.erase(list_map.at(x));
+    else Write_List.erase(list_map.at(x));
+    list_map.erase(x);
+    key_segment_map.erase(x);
+    bool dirty = (accessType.count(x) && accessType.at(x) == "Write");
+    accessType.erase(x);
+    return dirty;
+}
+
+template <class Observer>
+long long int CACHEUSCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::setWriteShare(double f) {
+    write_share = f;
+    write_segment_size = max(1, (int)(csize * write_share));
+    read_segment_size = max(0, csize - write_segment_size);
+}
+
+template <class Observer>
+double CACHEUSCacheT<Observer>::getWriteShare() {
+    return write_share;
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::resize(int n) {
+    csize = n;
+    // the segment targets keep their split
+    setWriteShare(write_share);
+    while (Read_List.size() + Write_List.size() > csize && evict()) {
+    }
+}
+
+template <class Observer>
+void CACHEUSCacheT<Observer>::residents(std::vector<std::pair<long long int, bool> >& out) {
+    out.clear();
+    KeyList* segments[2] = {&Read_List, &Write_List};
+    for (int l = 0; l < 2; l++) {
+        for (KeyList::reverse_iterator it = segments[l]->rbegin(); it != segments[l]->rend(); it++) {
+            out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Snapshot: the segment targets and their split, then the Read and Write segments MRU first
+// ------------------------------------------------------------------
+template <class Observer>
+bool CACHEUSCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "CACHEUS", csize);
+    snap_put(out, read_segment_size);
+    snap_put(out, write_segment_size);
+    snap_put(out, write_share);
+    KeyList* lists[2] = {&Read_List, &Write_List};
+    for (int l = 0; l < 2; l++) {
+        snap_put(out, (long long int)lists[l]->size());
+        for (KeyList::iterator it = lists[l]->begin(); it != lists[l]->end(); it++) {
+            snap_put_entry(out, *it, accessType.count(*it) && accessType.at(*it) == "Write");
+        }
+    }
+    return (bool)out;
+}
+
+template <class Observer>
+bool CACHEUSCacheT<Observer>::load(std::istream& in) {
+    if (!snap_check(in, "CACHEUS", csize) || !snap_get(in, read_segment_size) || !snap_get(in, write_segment_size) || !snap_get(in, write_share)) return false;
+    Read_List.clear();
+    Write_List.clear();
+    list_map.clear();
+    key_segment_map.clear();
+    accessType.clear();
+    KeyList* lists[2] = {&Read_List, &Write_List};
+    Segment segments[2] = {READ, WRITE};
+    for (int l = 0; l < 2; l++) {
+        long long int n = 0;
+        if (!snap_get(in, n)) return false;
+        for (long long int i = 0; i < n; i++) {
+            long long int x;
+            bool dirty;
+            if (!snap_get_entry(in, x, dirty)) return false;
+            lists[l]->push_back(x);
+            list_map[x] = --lists[l]->end();
+            key_segment_map[x] = segments[l];
+            if (dirty) accessType[x] = "Write";
+        }
+    }
+    return true;
+}
+
+// Batched references: the lookups of the whole batch are issued before the first update,
+// so their cache misses overlap instead of each one stalling the next; the updates then
+// run in order through refer(), so the result is that of referring the keys one by one.
+template <class Observer>
+void CACHEUSCacheT<Observer>::prefetch(const long long int* keys, int n) {
+    if (list_map.size() < PREFETCH_MIN_KEYS) return;
+    prefetch_buckets(key_segment_map, keys, n, batch_buckets);
+    prefetch_buckets(list_map, keys, n, batch_buckets);
+    prefetch_buckets(accessType, keys, n, batch_buckets);
+    for (int i = 0; i < n; i++) {
+        KeyMap<KeyList::iterator>::const_iterator it = list_map.find(keys[i]);
+        // the list node is moved on a hit
+        if (it != list_map.end()) __builtin_prefetch(&*it->second, 1);
+    }
+}
+
+template <class Observer>
+int CACHEUSCacheT<Observer>::refer_batch(const long long int* keys, const string* ops, int n, char* hit, long long int* dirty) {
+    prefetch(keys, n);
+    int hitKeys = 0;
+    for (int i = 0; i < n; i++) {
+        long long int before = evictedDirtyPage;
+        bool h = refer(keys[i], ops[i]);
+        if (hit) hit[i] = h;
+        if (dirty) dirty[i] = evictedDirtyPage - before;
+        hitKeys += h;
+    }
+    return hitKeys;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int CACHEUSCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Segment evictions for earlier pages of the run can remove later ones,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
 }
 
 
 // ------------------------------------------------------------------
 // Remaining Required Methods (Statistical Reporting)
 // ------------------------------------------------------------------
-void CACHEUSCache::display() {
+template <class Observer>
+void CACHEUSCacheT<Observer>::display() {
 	std::cout << "CACHEUS Cache displayed." << std::endl;
 }
 
-void CACHEUSCache::cachehits() {
+template <class Observer>
+void CACHEUSCacheT<Observer>::cachehits() {
     float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
 
 	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
@@ -195,12 +393,21 @@ void CACHEUSCache::cachehits() {
 	result.close();
 }
 
-void CACHEUSCache::refresh(){
+template <class Observer>
+void CACHEUSCacheT<Observer>::refresh(){
 	calls = 0;
 	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
 	migration = 0;
 }
 
-void CACHEUSCache::summary() {
+template <class Observer>
+void CACHEUSCacheT<Observer>::summary() {
 	// print the number of total cache calls, hits, and data migration size
-}
\ No newline at end of file
+}
+
+// The observers the simulator is built with (observer.h)
+template class CACHEUSCacheT<NullObserver>;
+template class CACHEUSCacheT<EventRecorder>;
@@ -3,32 +3,42 @@
 #include <unordered_map>
 #include <list>
 #include <algorithm> 
+#include <vector>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "arena.h"
 using namespace std; 
 #ifndef _cacheus_H
 #define _cacheus_H
 
-class CACHEUSCache
+template <class Observer = NullObserver>
+class CACHEUSCacheT
 {
 private:
+    // backs the lists and maps below when -G is given (arena.h)
+    MetadataArena arena;
+
     int csize; // Maximum total capacity of the cache (C)
     int write_segment_size; // Current size of the Write Segment
     int read_segment_size;  // Current size of the Read Segment
+    double write_share;     // Write Segment's share of csize, kept across resizes
 
     // Read Segment: Managed by LRU
-    std::list<long long int> Read_List; 
+    KeyList Read_List; 
     
     // Write Segment: Managed by LRU
-    std::list<long long int> Write_List; 
+    KeyList Write_List; 
     
     // Maps key to iterator in its respective list (Read or Write)
-    std::unordered_map<long long int, std::list<long long int>::iterator> list_map;
+    KeyMap<KeyList::iterator> list_map;
 
     // Maps key to its current segment
     enum Segment {NONE, READ, WRITE};
-    std::unordered_map<long long int, Segment> key_segment_map;
+    KeyMap<Segment> key_segment_map;
     
     // Tracks dirty status (inherited from LRU/LFU)
-    std::unordered_map<long long int, string> accessType; 
+    KeyMap<string> accessType; 
 
     // Statistics (Similar to others)
     long long int calls, total_calls;
@@ -36,20 +46,43 @@ private:
     long long int readHits; 
     long long int writeHits; 
     long long int evictedDirtyPage; 
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
     long long int migration, total_migration;
 
     // Helper functions for the CACHEUS policy
+    std::vector<size_t> batch_buckets; // scratch space for prefetch: each key's bucket
+
     void evict_read();
     void evict_write();
+    bool evict(); // evicts from one segment, false when the cache is empty
     void adapt_segments();
     
 public:
-    CACHEUSCache(int);
-    ~CACHEUSCache();
-    void refer(long long int, string);
+    CACHEUSCacheT(int, bool verbose = true);
+    ~CACHEUSCacheT();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    void prefetch(const long long int*, int); // brings the metadata of these keys into the CPU cache, changes nothing
+    int refer_batch(const long long int*, const string*, int, char* hit = NULL, long long int* dirty = NULL); // refer each key in order after prefetching them all, returns the hits; dirty: dirty victims per key
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts the segment over its target first
+    void setWriteShare(double); // change the segment split, the segment over its new target shrinks on later misses
+    double getWriteShare();
+    void residents(std::vector<std::pair<long long int, bool> >&); // resident keys and dirty bits, Read then Write segment, each LRU first
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
     void display();
     void cachehits();
     void refresh();
     void summary();
 };
-#endif
\ No newline at end of file
+
+typedef CACHEUSCacheT<> CACHEUSCache;
+#endif
@@ -0,0 +1,17 @@
+/* evictsink.h - Receiver of the blocks a cache policy evicts */
+using namespace std;
+#ifndef _evictsink_H
+#define _evictsink_H
+
+#define PAGE_SIZE 4096 // default size of one cached page in bytes
+
+// Policies report every victim, clean or dirty, to an optional sink: the
+// write-back buffer destages the dirty ones, a cache hierarchy demotes them
+// into the next tier.
+class EvictionSink
+{
+public:
+    virtual ~EvictionSink() {}
+    virtual void evicted(long long int key, bool dirty) = 0;
+};
+#endif
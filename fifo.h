@@ -0,0 +1,147 @@
+/* fifo.h - Ring buffer FIFO of keys with per-key visited and dirty bits (SIEVE, S3-FIFO) */
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+#ifndef _fifo_H
+#define _fifo_H
+
+// Keys in insertion order in a ring buffer, oldest at the tail. A hit only sets
+// the visited bit in the key's slot, no list pointers are written. A key removed
+// from the middle leaves a hole that is skipped; when the ring fills up the holes
+// are squeezed out. The ring has room for twice the keys it holds, so this is
+// amortised O(1).
+class KeyRing
+{
+public:
+    struct Slot {
+        long long int key; // -1 marks a hole
+        uint8_t visited;
+        uint8_t dirty;
+    };
+
+private:
+    std::vector<Slot> buf;
+    long long int tail; // logical position of the oldest slot
+    long long int head; // logical position after the newest slot
+    long long int hand; // SIEVE's hand, kept on the same key across compactions
+    std::unordered_map<long long int, long long int> pos; // key -> logical position
+
+    Slot& at(long long int i) {
+        return buf[i % (long long int)buf.size()];
+    }
+
+    void trim() {
+        while (tail < head && at(tail).key < 0) tail++;
+    }
+
+    void compact(long long int capacity) {
+        std::vector<Slot> next(capacity);
+        long long int n = 0;
+        long long int newHand = 0;
+        for (long long int i = tail; i < head; i++) {
+            if (i == hand) newHand = n; // a hand on a hole moves on to the next key
+            Slot& s = at(i);
+            if (s.key < 0) continue;
+            next[n] = s;
+            pos[s.key] = n;
+            n++;
+        }
+        if (hand >= head) newHand = n;
+        buf.swap(next);
+        tail = 0;
+        head = n;
+        hand = newHand;
+    }
+
+public:
+    KeyRing(int capacity) : buf(max(2, 2 * capacity)), tail(0), head(0), hand(0) {
+    }
+
+    int size() const {
+        return (int)pos.size();
+    }
+
+    Slot* find(long long int key) {
+        std::unordered_map<long long int, long long int>::iterator it = pos.find(key);
+        return (it == pos.end()) ? NULL : &at(it->second);
+    }
+
+    // Append as the newest key, not yet visited
+    void push(long long int key, bool dirty) {
+        if (head - tail == (long long int)buf.size()) {
+            compact(max((long long int)buf.size(), 2 * (long long int)pos.size() + 2));
+        }
+        Slot s = {key, 0, (uint8_t)(dirty ? 1 : 0)};
+        at(head) = s;
+        pos[key] = head;
+        head++;
+    }
+
+    // Remove the oldest key
+    bool pop(Slot& out) {
+        trim();
+        if (tail == head) return false;
+        out = at(tail);
+        pos.erase(out.key);
+        at(tail).key = -1;
+        tail++;
+        return true;
+    }
+
+    bool erase(long long int key, bool& dirty) {
+        std::unordered_map<long long int, long long int>::iterator it = pos.find(key);
+        if (it == pos.end()) return false;
+        Slot& s = at(it->second);
+        dirty = (s.dirty != 0);
+        s.key = -1;
+        pos.erase(it);
+        trim();
+        return true;
+    }
+
+    // The key under the hand, which walks from the oldest toward the newest key
+    // and wraps around; NULL when the ring is empty
+    Slot* sweep() {
+        if (pos.empty()) return NULL;
+        for (;;) {
+            if (hand < tail || hand >= head) hand = tail;
+            Slot& s = at(hand);
+            if (s.key >= 0) return &s;
+            hand++;
+        }
+    }
+
+    void advance() {
+        hand++;
+    }
+
+    // Number of keys older than the hand (snapshots)
+    long long int handIndex() {
+        long long int n = 0;
+        for (long long int i = tail; i < head && i < hand; i++) {
+            if (at(i).key >= 0) n++;
+        }
+        return n;
+    }
+
+    void setHandIndex(long long int n) {
+        // keys are appended without holes after a load, so the index is a position
+        hand = tail + n;
+    }
+
+    // Keys from the oldest, for snapshots
+    void keys(std::vector<Slot>& out) {
+        out.clear();
+        for (long long int i = tail; i < head; i++) {
+            if (at(i).key >= 0) out.push_back(at(i));
+        }
+    }
+
+    void clear() {
+        pos.clear();
+        tail = head = hand = 0;
+    }
+};
+#endif
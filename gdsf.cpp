@@ -0,0 +1,248 @@
+/* gdsf.cpp - GDSF (Greedy-Dual-Size-Frequency) size-aware Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <math.h>
+#include "gdsf.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+GDSFCache::GDSFCache(long long int n, string policy) {
+    csize = n;
+    used = 0;
+    L = 0;
+    clock = 0;
+
+    name = policy;
+    if (policy == "LRU") scoring = LRU_SCORE;
+    else if (policy == "LFU") scoring = LFU_SCORE;
+    else if (policy == "GDS") scoring = GDS_SCORE;
+    else scoring = GDSF_SCORE;
+
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    requestedBytes = 0;
+    hitBytes = 0;
+    evictedDirtyBytes = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "Size-aware " << name << " Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << " bytes" << std::endl;
+}
+
+GDSFCache::~GDSFCache() {
+    queue.clear();
+    objects.clear();
+}
+
+// ------------------------------------------------------------------
+// GDSF Helper Functions
+// ------------------------------------------------------------------
+double GDSFCache::priority(const Object& o) {
+    // Cost is uniform (1 per object), which makes the policy optimise object hit ratio
+    switch (scoring) {
+    case LRU_SCORE: return (double)clock;
+    case LFU_SCORE: return L + o.freq;
+    case GDS_SCORE: return L + 1.0 / o.size;
+    default:        return L + (double)o.freq / o.size;
+    }
+}
+
+void GDSFCache::evict() {
+    // Evict the object with the lowest priority and inflate L to its priority
+    std::map<std::pair<double, long long int>, long long int>::iterator it = queue.begin();
+    long long int victim = it->second;
+    if (scoring != LRU_SCORE) L = it->first.first;
+    queue.erase(it);
+
+    Object& o = objects.at(victim);
+    used -= o.size;
+    write_back(victim, o.size, o.dirty);
+    objects.erase(victim);
+}
+
+void GDSFCache::write_back(long long int victim, int size, bool dirty) {
+    if (dirty) {
+        evictedDirtyPage++;
+        evictedDirtyBytes += size;
+    }
+    // The sink sees the object as the run of pages it covers
+    if (sink) {
+        for (int i = 0; i < (int)ceil(size / (double)page_size); i++) sink->evicted(victim + (long long int)i * page_size, dirty);
+    }
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core GDSF Logic)
+// ------------------------------------------------------------------
+bool GDSFCache::refer(long long int x, int size, string rwtype) {
+    calls++;
+    clock++;
+    if (size <= 0) size = 1;
+    requestedBytes += size;
+
+    std::unordered_map<long long int, Object>::iterator found = objects.find(x);
+
+    // --- 1. HIT ---
+    if (found != objects.end() && found->second.size >= size) {
+        Object& o = found->second;
+        hits++;
+        hitBytes += size;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+        if (rwtype == "Write") o.dirty = true;
+
+        o.freq++;
+        queue.erase(o.pos);
+        o.pos = queue.insert(std::make_pair(std::make_pair(priority(o), clock), x)).first;
+        return true;
+    }
+
+    // --- 2. MISS ---
+    // A larger request for a resident key replaces the smaller cached object
+    bool dirty = (rwtype == "Write");
+    int freq = 1;
+    if (found != objects.end()) {
+        dirty = dirty || found->second.dirty;
+        freq = found->second.freq + 1;
+        used -= found->second.size;
+        queue.erase(found->second.pos);
+        objects.erase(found);
+    }
+
+    // Objects larger than the whole cache bypass it
+    if (size > csize) {
+        if (dirty) write_back(x, size, true);
+        return false;
+    }
+
+    while (used + size > csize) {
+        evict();
+    }
+
+    Object o;
+    o.size = size;
+    o.freq = freq;
+    o.dirty = dirty;
+    o.pos = queue.insert(std::make_pair(std::make_pair(priority(o), clock), x)).first;
+    objects[x] = o;
+    used += size;
+    return false;
+}
+
+bool GDSFCache::contains(long long int x) {
+    return objects.count(x) > 0;
+}
+
+bool GDSFCache::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed as a one-page object like a miss, but it is not a demand reference
+    refer(x, page_size, rwtype);
+    calls--;
+    requestedBytes -= page_size;
+    return true;
+}
+
+bool GDSFCache::remove(long long int x) {
+    std::unordered_map<long long int, Object>::iterator found = objects.find(x);
+    if (found == objects.end()) return false;
+    bool dirty = found->second.dirty;
+    used -= found->second.size;
+    queue.erase(found->second.pos);
+    objects.erase(found);
+    return dirty;
+}
+
+long long int GDSFCache::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+void GDSFCache::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+void GDSFCache::setPageSize(int n) {
+    page_size = n;
+}
+
+// ------------------------------------------------------------------
+// Snapshot: L and the clock, then every object in eviction order with its priority
+// ------------------------------------------------------------------
+bool GDSFCache::save(std::ostream& out) {
+    snap_header(out, name, csize);
+    snap_put(out, L);
+    snap_put(out, clock);
+    snap_put(out, (long long int)queue.size());
+    for (std::map<std::pair<double, long long int>, long long int>::iterator it = queue.begin(); it != queue.end(); it++) {
+        const Object& o = objects.at(it->second);
+        snap_put_entry(out, it->second, o.dirty);
+        snap_put(out, o.size);
+        snap_put(out, o.freq);
+        snap_put(out, it->first.first);
+        snap_put(out, it->first.second);
+    }
+    return (bool)out;
+}
+
+bool GDSFCache::load(std::istream& in) {
+    long long int n = 0;
+    if (!snap_check(in, name, csize) || !snap_get(in, L) || !snap_get(in, clock) || !snap_get(in, n)) return false;
+    queue.clear();
+    objects.clear();
+    used = 0;
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        Object o;
+        std::pair<double, long long int> rank;
+        if (!snap_get_entry(in, x, dirty) || !snap_get(in, o.size) || !snap_get(in, o.freq) || !snap_get(in, rank.first) || !snap_get(in, rank.second)) return false;
+        o.dirty = dirty;
+        o.pos = queue.insert(std::make_pair(rank, x)).first;
+        objects[x] = o;
+        used += o.size;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Remaining Required Methods (Statistical Reporting)
+// ------------------------------------------------------------------
+void GDSFCache::display() {
+    std::cout << "GDSF Cache displayed." << std::endl;
+}
+
+void GDSFCache::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+    float byteHitRatio = (requestedBytes > 0) ? (float)hitBytes / requestedBytes : 0.0;
+
+    std::cout << "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " << writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+    std::cout << "objectHitRatio: " << hitRatio << ", requestedBytes: " << requestedBytes << ", hitBytes: " << hitBytes << ", byteHitRatio: " << byteHitRatio << ", evictedDirtyBytes: " << evictedDirtyBytes << std::endl;
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << name << "-Size " << "CacheBytes " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " requestedBytes " << requestedBytes << " hitBytes " << hitBytes << " byteHitRatio " << byteHitRatio << " evictedDirtyBytes " << evictedDirtyBytes << "\n";
+    }
+    result.close();
+}
+
+void GDSFCache::refresh() {
+    calls = 0;
+    hits = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    requestedBytes = 0;
+    hitBytes = 0;
+    evictedDirtyBytes = 0;
+}
+
+void GDSFCache::summary() {
+    // print the number of total cache calls, hits, and data migration size
+}
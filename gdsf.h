@@ -0,0 +1,73 @@
+/* gdsf.h - GDSF (Greedy-Dual-Size-Frequency) size-aware Cache Policy, capacity in bytes */
+#include <string>
+#include <unordered_map>
+#include <map>
+#include "evictsink.h"
+#include "snapshot.h"
+using namespace std;
+#ifndef _gdsf_H
+#define _gdsf_H
+
+class GDSFCache
+{
+private:
+    long long int csize;     // Maximum capacity of the cache in bytes
+    long long int used;      // Bytes currently charged against csize
+    double L;                // Inflation value: priority of the last evicted object (ages old entries)
+    long long int clock;     // Reference counter, used for LRU priority and as a tie-breaker
+
+    // Scoring used to rank objects; all variants charge each object its size against csize
+    //   LRU:  H = clock                      (size-aware capacity, recency order)
+    //   LFU:  H = L + freq                   (LFU with dynamic aging)
+    //   GDS:  H = L + cost / size            (Greedy-Dual-Size)
+    //   GDSF: H = L + freq * cost / size     (Greedy-Dual-Size-Frequency)
+    enum Scoring {LRU_SCORE, LFU_SCORE, GDS_SCORE, GDSF_SCORE};
+    Scoring scoring;
+    string name;
+
+    struct Object {
+        int size;
+        int freq;
+        bool dirty;
+        std::map<std::pair<double, long long int>, long long int>::iterator pos;
+    };
+
+    // Priority queue: (H, clock) -> key, the lowest H is evicted first
+    std::map<std::pair<double, long long int>, long long int> queue;
+    // Resident objects
+    std::unordered_map<long long int, Object> objects;
+
+    // Statistics (Similar to LRU/LFU), plus byte counters
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage; // dirty objects evicted
+    long long int requestedBytes;
+    long long int hitBytes;
+    long long int evictedDirtyBytes;
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    int page_size;       // dirty objects are destaged as runs of pages
+
+    double priority(const Object&);
+    void evict();
+    void write_back(long long int, int, bool);
+
+public:
+    GDSFCache(long long int, string);
+    ~GDSFCache();
+    bool refer(long long int, int, string); // one object of the given size, returns true on a cache hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+#endif
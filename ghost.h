@@ -0,0 +1,331 @@
+/* ghost.h - Compact ghost histories: 16-bit fingerprints in a cuckoo table with FIFO aging */
+#include <vector>
+#include <iostream>
+#include <stdint.h>
+#include "snapshot.h"
+using namespace std;
+#ifndef _ghost_H
+#define _ghost_H
+
+#define GHOST_BUCKET_SLOTS 4    // tags per cuckoo bucket
+#define GHOST_MAX_LOAD 0.9      // table sized so the history fills at most this share of the slots
+#define GHOST_MAX_KICKS 500     // relocations tried before an insert gives up on one tag
+
+// A ghost list that forgets the keys: each entry is a 16-bit tag in one of two
+// candidate buckets (partial-key cuckoo hashing), plus its place in a FIFO ring
+// so the oldest entry can be aged out. About 11 bytes per entry instead of a list
+// node and hash map entries holding the full key. A key whose tag and bucket
+// match an entry is taken for it: a false positive, roughly 8 / 65536 per lookup.
+// Up to capacity entries are kept; only an insert into a full filter ages one out.
+class GhostFilter
+{
+private:
+    std::vector<uint16_t> tags;   // 0 marks an empty slot
+    std::vector<uint16_t> ages;   // low bits of the entry's ring position, so aging removes
+                                  // the entry it inserted and not a newer one with the same tag
+    std::vector<uint32_t> stamps; // optional 32-bit payload per slot (LIRS recency)
+    uint32_t mask;                // buckets - 1
+
+    // FIFO of every insert, oldest first: the bucket hash and tag, enough to find
+    // the entry again. Entries erased on a ghost hit stay in the ring until it
+    // fills, then the ring is squeezed down to the entries still in the table.
+    std::vector<uint32_t> ringIndex;
+    std::vector<uint16_t> ringTag;
+    long long int ringTail, ringHead;
+
+    long long int capacity;  // entries kept before the oldest is aged out
+    long long int live;      // entries in the table
+    long long int overflows; // tags dropped because no relocation found a free slot
+    uint32_t rng;            // xorshift state for the cuckoo victim choice
+    bool stamped;            // slots carry a stamp
+
+    static void hash(long long int key, uint32_t& index, uint16_t& tag) {
+        unsigned long long z = (unsigned long long)key + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        index = (uint32_t)z;
+        tag = (uint16_t)(z >> 48);
+        if (tag == 0) tag = 1;
+    }
+
+    uint32_t alt(uint32_t bucket, uint16_t tag) const {
+        // an odd offset keeps the two candidate buckets apart in small tables
+        return (bucket ^ ((tag * 0x5BD1E995u) | 1)) & mask;
+    }
+
+    uint32_t next_random() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    // Slot holding tag in either candidate bucket, or -1; age -1 matches any age
+    long long int locate(uint32_t index, uint16_t tag, long long int age) const {
+        uint32_t b[2] = {index & mask, alt(index & mask, tag)};
+        for (int i = 0; i < 2; i++) {
+            for (int s = 0; s < GHOST_BUCKET_SLOTS; s++) {
+                long long int slot = (long long int)b[i] * GHOST_BUCKET_SLOTS + s;
+                if (tags[slot] == tag && (age < 0 || ages[slot] == (uint16_t)age)) return slot;
+            }
+        }
+        return -1;
+    }
+
+    bool place(uint32_t bucket, uint16_t tag, uint16_t age, uint32_t stamp) {
+        for (int s = 0; s < GHOST_BUCKET_SLOTS; s++) {
+            long long int slot = (long long int)bucket * GHOST_BUCKET_SLOTS + s;
+            if (tags[slot] == 0) {
+                tags[slot] = tag;
+                ages[slot] = age;
+                if (!stamps.empty()) stamps[slot] = stamp;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add(uint32_t index, uint16_t tag, uint16_t age, uint32_t stamp) {
+        uint32_t b = index & mask;
+        if (place(b, tag, age, stamp) || place(alt(b, tag), tag, age, stamp)) {
+            live++;
+            return;
+        }
+        // Both buckets full: move a random resident tag to its other bucket
+        b = (next_random() & 1) ? b : alt(b, tag);
+        for (int k = 0; k < GHOST_MAX_KICKS; k++) {
+            long long int slot = (long long int)b * GHOST_BUCKET_SLOTS + next_random() % GHOST_BUCKET_SLOTS;
+            std::swap(tag, tags[slot]);
+            std::swap(age, ages[slot]);
+            if (!stamps.empty()) std::swap(stamp, stamps[slot]);
+            b = alt(b, tag);
+            if (place(b, tag, age, stamp)) {
+                live++;
+                return;
+            }
+        }
+        // The tag left in hand is forgotten early, as if it had aged out
+        overflows++;
+    }
+
+    bool take(uint32_t index, uint16_t tag, long long int age, uint32_t* stamp) {
+        long long int slot = locate(index, tag, age);
+        if (slot < 0) return false;
+        if (stamp) *stamp = stamps.empty() ? 0 : stamps[slot];
+        tags[slot] = 0;
+        live--;
+        return true;
+    }
+
+    // Drop the ring entries whose tag left the table (erased, or lost to an
+    // overflow) and renumber the rest from 0. Slots are found with the old ages
+    // before any is rewritten, so a renumbered entry is not taken for another.
+    void compact_ring() {
+        long long int size = (long long int)ringIndex.size();
+        std::vector<uint32_t> index;
+        std::vector<uint16_t> tag;
+        std::vector<long long int> slots;
+        for (long long int i = ringTail; i < ringHead; i++) {
+            long long int r = i % size;
+            long long int slot = locate(ringIndex[r], ringTag[r], (uint16_t)i);
+            if (slot < 0) continue;
+            index.push_back(ringIndex[r]);
+            tag.push_back(ringTag[r]);
+            slots.push_back(slot);
+        }
+        for (size_t i = 0; i < slots.size(); i++) {
+            ringIndex[i] = index[i];
+            ringTag[i] = tag[i];
+            ages[slots[i]] = (uint16_t)i;
+        }
+        ringTail = 0;
+        ringHead = (long long int)slots.size();
+    }
+
+    // Append to the ring and the table
+    void push(uint32_t index, uint16_t tag, uint32_t stamp) {
+        // a full filter ages out its oldest entry, the same one an exact FIFO history would
+        if (live >= capacity) {
+            pop();
+        }
+        // the ring holds twice the capacity, so squeezing it leaves room for as many inserts as it keeps
+        if (ringHead - ringTail == (long long int)ringIndex.size()) {
+            compact_ring();
+        }
+        long long int r = ringHead % (long long int)ringIndex.size();
+        ringIndex[r] = index;
+        ringTag[r] = tag;
+        add(index, tag, (uint16_t)ringHead, stamp);
+        ringHead++;
+    }
+
+    void build(long long int capacity) {
+        long long int buckets = 1;
+        while (buckets * GHOST_BUCKET_SLOTS * GHOST_MAX_LOAD < capacity) buckets *= 2;
+        mask = (uint32_t)(buckets - 1);
+        tags.assign(buckets * GHOST_BUCKET_SLOTS, 0);
+        ages.assign(buckets * GHOST_BUCKET_SLOTS, 0);
+        if (stamped) stamps.assign(buckets * GHOST_BUCKET_SLOTS, 0);
+        // the ring has slack for entries erased on a ghost hit
+        this->capacity = max(1LL, capacity);
+        ringIndex.assign(2 * this->capacity, 0);
+        ringTag.assign(2 * this->capacity, 0);
+        ringTail = ringHead = 0;
+        live = 0;
+    }
+
+public:
+    GhostFilter(long long int capacity, bool withStamps) : mask(0), ringTail(0), ringHead(0), capacity(1), live(0), overflows(0), rng(2463534242u), stamped(withStamps) {
+        build(capacity);
+    }
+
+    long long int size() const {
+        return live;
+    }
+
+    long long int getOverflows() const {
+        return overflows;
+    }
+
+    // For a key that matched: false if no entry was inserted for it. The ring
+    // keeps the full 48-bit hash of each entry, so a tag that another key
+    // left behind is told apart.
+    bool verify(long long int key) const {
+        uint32_t index;
+        uint16_t tag;
+        hash(key, index, tag);
+        long long int size = (long long int)ringIndex.size();
+        uint32_t b[2] = {index & mask, alt(index & mask, tag)};
+        for (int i = 0; i < 2; i++) {
+            for (int s = 0; s < GHOST_BUCKET_SLOTS; s++) {
+                long long int slot = (long long int)b[i] * GHOST_BUCKET_SLOTS + s;
+                if (tags[slot] != tag) continue;
+                // ring positions whose low 16 bits are the slot's age, newest first
+                long long int p = ringHead - 1 - (uint16_t)((uint16_t)(ringHead - 1) - ages[slot]);
+                for (; p >= ringTail; p -= 65536) {
+                    long long int r = p % size;
+                    if (ringTag[r] == tag && ringIndex[r] == index) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool contains(long long int key) const {
+        uint32_t index;
+        uint16_t tag;
+        hash(key, index, tag);
+        return locate(index, tag, -1) >= 0;
+    }
+
+    // Payload of the entry matching key, false if there is none
+    bool find(long long int key, uint32_t& stamp) const {
+        uint32_t index;
+        uint16_t tag;
+        hash(key, index, tag);
+        long long int slot = locate(index, tag, -1);
+        if (slot < 0) return false;
+        stamp = stamps.empty() ? 0 : stamps[slot];
+        return true;
+    }
+
+    // Remember key as the newest entry
+    void insert(long long int key, uint32_t stamp) {
+        uint32_t index;
+        uint16_t tag;
+        hash(key, index, tag);
+        push(index, tag, stamp);
+    }
+
+    bool erase(long long int key) {
+        uint32_t index;
+        uint16_t tag;
+        hash(key, index, tag);
+        return take(index, tag, -1, NULL);
+    }
+
+    // Age out the oldest entry still in the table
+    bool pop() {
+        while (ringTail < ringHead) {
+            long long int r = ringTail % (long long int)ringIndex.size();
+            if (take(ringIndex[r], ringTag[r], (uint16_t)ringTail++, NULL)) return true;
+        }
+        return false;
+    }
+
+    // Rebuild for a new capacity, keeping the newest entries that fit
+    void resize(long long int capacity) {
+        std::vector<uint32_t> index, stamp;
+        std::vector<uint16_t> tag;
+        while (ringTail < ringHead) {
+            long long int r = ringTail % (long long int)ringIndex.size();
+            uint32_t s = 0;
+            if (take(ringIndex[r], ringTag[r], (uint16_t)ringTail++, &s)) {
+                index.push_back(ringIndex[r]);
+                tag.push_back(ringTag[r]);
+                stamp.push_back(s);
+            }
+        }
+        build(capacity);
+        size_t first = (index.size() > (size_t)capacity) ? index.size() - capacity : 0;
+        for (size_t i = first; i < index.size(); i++) {
+            push(index[i], tag[i], stamp[i]);
+        }
+    }
+
+    void clear() {
+        std::fill(tags.begin(), tags.end(), 0);
+        ringTail = ringHead = 0;
+        live = 0;
+    }
+
+    // Heap bytes of the table and the ring
+    long long int bytes() const {
+        return (long long int)((tags.size() + ages.size()) * sizeof(uint16_t) + stamps.size() * sizeof(uint32_t) + ringIndex.size() * (sizeof(uint32_t) + sizeof(uint16_t)));
+    }
+
+    // The table and ring as they are, so a restore finds every tag in its slot
+    bool save(std::ostream& out) const {
+        snap_put(out, (long long int)tags.size());
+        snap_put(out, (long long int)ringIndex.size());
+        snap_put(out, ringTail);
+        snap_put(out, ringHead);
+        snap_put(out, live);
+        snap_put(out, rng);
+        out.write((const char*)&tags[0], tags.size() * sizeof(uint16_t));
+        out.write((const char*)&ages[0], ages.size() * sizeof(uint16_t));
+        if (!stamps.empty()) out.write((const char*)&stamps[0], stamps.size() * sizeof(uint32_t));
+        out.write((const char*)&ringIndex[0], ringIndex.size() * sizeof(uint32_t));
+        out.write((const char*)&ringTag[0], ringTag.size() * sizeof(uint16_t));
+        return (bool)out;
+    }
+
+    bool load(std::istream& in) {
+        long long int slots = 0, ring = 0;
+        if (!snap_get(in, slots) || !snap_get(in, ring)) return false;
+        if (slots != (long long int)tags.size() || ring != (long long int)ringIndex.size()) {
+            std::cerr << "error: snapshot ghost table does not match this cache size" << std::endl;
+            return false;
+        }
+        if (!snap_get(in, ringTail) || !snap_get(in, ringHead) || !snap_get(in, live) || !snap_get(in, rng)) return false;
+        in.read((char*)&tags[0], tags.size() * sizeof(uint16_t));
+        in.read((char*)&ages[0], ages.size() * sizeof(uint16_t));
+        if (!stamps.empty()) in.read((char*)&stamps[0], stamps.size() * sizeof(uint32_t));
+        in.read((char*)&ringIndex[0], ringIndex.size() * sizeof(uint32_t));
+        in.read((char*)&ringTag[0], ringTag.size() * sizeof(uint16_t));
+        return (bool)in;
+    }
+};
+
+// Approximate heap bytes per entry of the node-based containers that hold exact
+// ghost entries (libstdc++ node layouts, allocator overhead not counted)
+inline long long int list_entry_bytes() {
+    return 2 * sizeof(void*) + sizeof(long long int);
+}
+
+inline long long int map_entry_bytes(long long int value) {
+    // node: next pointer, key, value padded to 8; plus one bucket pointer at load factor 1
+    return 2 * sizeof(void*) + sizeof(long long int) + ((value + 7) / 8) * 8;
+}
+#endif
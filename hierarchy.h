@@ -0,0 +1,321 @@
+/* hierarchy.h - Multi-tier cache hierarchy (e.g. DRAM over Optane over the backing store) */
+#include <string>
+#include <vector>
+#include <deque>
+#include <iostream>
+#include <fstream>
+#include "evictsink.h"
+#include "snapshot.h"
+using namespace std;
+#ifndef _hierarchy_H
+#define _hierarchy_H
+
+// Two or more instances of one page policy stacked on top of each other, tier 0
+// being the fastest. Every request is looked up from the top down.
+//
+// Inclusive: each tier holds a copy of every page above it. A miss fills all
+// tiers down to the one that hit, a clean victim simply disappears from its tier,
+// a dirty victim is written back into the copy one tier down, and a victim of a
+// lower tier is invalidated in every tier above it.
+//
+// Exclusive: each page lives in exactly one tier. A hit below tier 0 promotes the
+// page into tier 0 and every tier's victims are demoted into the next tier.
+//
+// Victims leaving the last tier go to the hierarchy's own sink (write-back buffer).
+template <class Cache>
+class CacheHierarchy
+{
+private:
+    struct Victim {
+        int tier;
+        long long int key;
+        bool dirty;
+    };
+
+    // Queues one tier's victims; they are moved only after the policy call that
+    // evicted them has returned, so no tier is re-entered from inside itself
+    struct TierSink : public EvictionSink {
+        std::deque<Victim>* pending;
+        int tier;
+        void evicted(long long int key, bool dirty) {
+            Victim v = {tier, key, dirty};
+            pending->push_back(v);
+        }
+    };
+
+    int levels;
+    bool exclusive;
+    string policy;
+    std::vector<int> sizes;
+    std::vector<Cache*> tiers;
+    std::vector<TierSink> sinks;
+    std::deque<Victim> pending;
+    EvictionSink* sink; // receiver of the victims that leave the last tier
+    int page_size;
+
+    // Statistics
+    long long int calls;
+    long long int hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;    // dirty pages leaving the last tier
+    std::vector<long long int> tierHits;   // pages served by each tier
+    std::vector<long long int> promotions; // pages moved up out of each tier
+    std::vector<long long int> demotions;  // pages (exclusive) or dirty write-backs (inclusive) moved down out of each tier
+    long long int invalidations;       // upper-tier copies dropped to keep the hierarchy inclusive
+    long long int migratedBytes;       // bytes copied between tiers in either direction
+    std::vector<int> requestHits;      // per-tier hit pages of the request being served
+
+    CacheHierarchy(const CacheHierarchy&);
+    CacheHierarchy& operator=(const CacheHierarchy&);
+
+    void leave(long long int key, bool dirty) {
+        if (dirty) evictedDirtyPage++;
+        if (sink) sink->evicted(key, dirty);
+    }
+
+    // Move every queued victim; a move may evict from the next tier and queue more
+    void drain() {
+        while (!pending.empty()) {
+            Victim v = pending.front();
+            pending.pop_front();
+            if (exclusive) {
+                if (v.tier + 1 == levels) {
+                    leave(v.key, v.dirty);
+                    continue;
+                }
+                demotions[v.tier]++;
+                migratedBytes += page_size;
+                tiers[v.tier + 1]->install(v.key, v.dirty ? "Write" : "Read");
+            } else {
+                // the tiers above may not keep a page the tier below has dropped;
+                // a dirty copy up there makes the departing page dirty
+                for (int i = 0; i < v.tier; i++) {
+                    if (tiers[i]->contains(v.key)) {
+                        if (tiers[i]->remove(v.key)) v.dirty = true;
+                        invalidations++;
+                    }
+                }
+                if (v.tier + 1 == levels) {
+                    leave(v.key, v.dirty);
+                } else if (v.dirty) {
+                    // the write-back is an access the lower tier sees
+                    demotions[v.tier]++;
+                    migratedBytes += page_size;
+                    tiers[v.tier + 1]->refer(v.key, "Write");
+                }
+            }
+        }
+    }
+
+public:
+    CacheHierarchy(const std::vector<int>& tierSizes, bool isExclusive, string name) {
+        levels = (int)tierSizes.size();
+        exclusive = isExclusive;
+        policy = name;
+        sizes = tierSizes;
+        sink = NULL;
+        page_size = PAGE_SIZE;
+
+        // sinks is sized once, so the addresses handed to the tiers stay valid
+        sinks.resize(levels);
+        for (int i = 0; i < levels; i++) {
+            std::cout << "Tier " << i << ": ";
+            tiers.push_back(new Cache(sizes[i]));
+            sinks[i].pending = &pending;
+            sinks[i].tier = i;
+            tiers[i]->setEvictionSink(&sinks[i]);
+        }
+        std::cout << "Cache hierarchy: " << levels << " " << (exclusive ? "exclusive" : "inclusive") << " tiers of " << policy << std::endl;
+
+        tierHits.assign(levels, 0);
+        promotions.assign(levels, 0);
+        demotions.assign(levels, 0);
+        requestHits.assign(levels, 0);
+        calls = 0;
+        hits = 0;
+        readHits = 0;
+        writeHits = 0;
+        evictedDirtyPage = 0;
+        invalidations = 0;
+        migratedBytes = 0;
+    }
+
+    ~CacheHierarchy() {
+        for (int i = 0; i < levels; i++) delete tiers[i];
+        tiers.clear();
+        pending.clear();
+    }
+
+    // returns true if any tier held the page
+    bool refer(long long int x, string rwtype) {
+        calls++;
+        int t = 0;
+        while (t < levels && !tiers[t]->contains(x)) t++;
+
+        if (exclusive) {
+            if (t > 0 && t < levels) {
+                // promotion: the page leaves its tier and is referenced at the top
+                bool dirty = tiers[t]->remove(x);
+                promotions[t]++;
+                migratedBytes += page_size;
+                tiers[0]->refer(x, (dirty || rwtype == "Write") ? "Write" : "Read");
+            } else {
+                tiers[0]->refer(x, rwtype);
+            }
+            drain();
+        } else {
+            // every tier above the one that hit missed, and is filled on the way up
+            int deepest = (t < levels) ? t : levels - 1;
+            for (int i = deepest; i >= 0; i--) {
+                tiers[i]->refer(x, rwtype);
+                drain();
+            }
+            if (t > 0 && t < levels) promotions[t]++;
+            migratedBytes += (long long int)deepest * page_size;
+        }
+
+        if (t == levels) return false;
+        hits++;
+        tierHits[t]++;
+        requestHits[t]++;
+        if (rwtype == "Read") readHits++;
+        else writeHits++;
+        return true;
+    }
+
+    int refer_range(long long int offset, int length, string rwtype) {
+        requestHits.assign(levels, 0);
+        if (length <= 0) return 0;
+        // align to whole pages so the same physical page always maps to the same key
+        long long int first = offset - offset % page_size;
+        int n = (int)((offset + length - 1) / page_size - offset / page_size + 1);
+        int hitPages = 0;
+        for (int i = 0; i < n; i++) {
+            if (refer(first + (long long int)i * page_size, rwtype)) hitPages++;
+        }
+        return hitPages;
+    }
+
+    // hit pages of the last refer_range call, per tier
+    const std::vector<int>& getRequestTierHits() {
+        return requestHits;
+    }
+
+    bool contains(long long int x) {
+        for (int i = 0; i < levels; i++) {
+            if (tiers[i]->contains(x)) return true;
+        }
+        return false;
+    }
+
+    // Installed at the top (exclusive) or in every tier (inclusive), like a miss
+    bool install(long long int x, string rwtype) {
+        if (contains(x)) return false;
+        int deepest = exclusive ? 0 : levels - 1;
+        for (int i = deepest; i >= 0; i--) {
+            tiers[i]->install(x, rwtype);
+            drain();
+        }
+        return true;
+    }
+
+    bool remove(long long int x) {
+        bool dirty = false;
+        for (int i = 0; i < levels; i++) {
+            if (tiers[i]->contains(x) && tiers[i]->remove(x)) dirty = true;
+        }
+        return dirty;
+    }
+
+    long long int getEvictedDirtyPage() {
+        return evictedDirtyPage;
+    }
+
+    void setEvictionSink(EvictionSink* s) {
+        sink = s;
+    }
+
+    void setPageSize(int n) {
+        page_size = n;
+        for (int i = 0; i < levels; i++) tiers[i]->setPageSize(n);
+    }
+
+    // Snapshot: the tier count and mode, then each tier's own snapshot from the top
+    bool save(std::ostream& out) {
+        snap_header(out, "Hierarchy", levels);
+        snap_put(out, (uint8_t)(exclusive ? 1 : 0));
+        for (int i = 0; i < levels; i++) {
+            if (!tiers[i]->save(out)) return false;
+        }
+        return (bool)out;
+    }
+
+    bool load(std::istream& in) {
+        uint8_t mode = 0;
+        if (!snap_check(in, "Hierarchy", levels) || !snap_get(in, mode)) return false;
+        if ((mode != 0) != exclusive) {
+            std::cerr << "error: snapshot holds an " << (mode ? "exclusive" : "inclusive") << " hierarchy" << std::endl;
+            return false;
+        }
+        for (int i = 0; i < levels; i++) {
+            if (!tiers[i]->load(in)) return false;
+        }
+        return true;
+    }
+
+    void display() {
+        for (int i = 0; i < levels; i++) {
+            std::cout << "Tier " << i << ": ";
+            tiers[i]->display();
+        }
+    }
+
+    void cachehits() {
+        float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+        long long int promoted = 0;
+        long long int demoted = 0;
+        for (int i = 0; i < levels; i++) {
+            promoted += promotions[i];
+            demoted += demotions[i];
+        }
+
+        std::cout << "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " << writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+        std::cout << "promotions: " << promoted << ", demotions: " << demoted << ", invalidations: " << invalidations << ", migratedBytes(MB): " << (double)migratedBytes / 1024 / 1024 << std::endl;
+        for (int i = 0; i < levels; i++) {
+            std::cout << "tier " << i << ": size " << sizes[i] << ", hits " << tierHits[i] << ", hitRatio " << ((calls > 0) ? (float)tierHits[i] / calls : 0.0) << ", promotions " << promotions[i] << ", demotions " << demotions[i] << std::endl;
+        }
+
+        std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+        if (result.is_open()) {
+            result << policy << " Hierarchy " << (exclusive ? "exclusive" : "inclusive") << " tiers " << levels << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " writeHits " << writeHits << " evictedDirtyPage " << evictedDirtyPage << " promotions " << promoted << " demotions " << demoted << " invalidations " << invalidations << " migratedBytes " << migratedBytes;
+            for (int i = 0; i < levels; i++) {
+                result << " tier" << i << " " << sizes[i] << " " << tierHits[i] << " " << promotions[i] << " " << demotions[i];
+            }
+            result << "\n";
+        }
+        result.close();
+    }
+
+    void refresh() {
+        calls = 0;
+        hits = 0;
+        readHits = 0;
+        writeHits = 0;
+        evictedDirtyPage = 0;
+        invalidations = 0;
+        migratedBytes = 0;
+        tierHits.assign(levels, 0);
+        promotions.assign(levels, 0);
+        demotions.assign(levels, 0);
+        for (int i = 0; i < levels; i++) tiers[i]->refresh();
+    }
+
+    void summary() {
+        for (int i = 0; i < levels; i++) {
+            std::cout << "Tier " << i << ": ";
+            tiers[i]->summary();
+        }
+    }
+};
+#endif
@@ -0,0 +1,145 @@
+/* latency.cpp - Storage device latency model Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <math.h>
+#include "latency.h"
+using namespace std;
+
+#define LATENCY_BASE 1.01   // histogram bucket growth factor (1% resolution)
+#define LATENCY_BUCKETS 2400 // 1.01^2400 us is ~6 hours, far above any request
+#define LATENCY_STREAM_GAIN 100 // a page streamed within one write I/O costs 1/100 of a random write
+                                // (5ms positioning vs ~50us per 4KB at ~80MB/s)
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+LatencyModel::LatencyModel(double hit, double read, double write) {
+    hitLatency = hit;
+    readLatency = read;
+    writeLatency = write;
+    writeTransfer = write / LATENCY_STREAM_GAIN;
+
+    histogram.assign(LATENCY_BUCKETS + 1, 0);
+    requests = 0;
+    totalLatency = 0;
+    maxLatency = 0;
+}
+
+LatencyModel::~LatencyModel() {
+    histogram.clear();
+}
+
+// ------------------------------------------------------------------
+// Histogram helpers
+// ------------------------------------------------------------------
+int LatencyModel::bucket(double lat) const {
+    // bucket 0 holds everything below 1us, bucket i covers [BASE^(i-1), BASE^i)
+    if (lat < 1.0) return 0;
+    int b = (int)(log(lat) / log(LATENCY_BASE)) + 1;
+    return min(b, LATENCY_BUCKETS);
+}
+
+double LatencyModel::percentile(double q) const {
+    if (requests == 0) return 0.0;
+    long long int target = (long long int)ceil(q * requests);
+    long long int seen = 0;
+    for (int b = 0; b <= LATENCY_BUCKETS; b++) {
+        seen += histogram[b];
+        if (seen >= target) {
+            // report the bucket's upper edge, but never above the largest latency observed
+            return min(pow(LATENCY_BASE, b), maxLatency);
+        }
+    }
+    return maxLatency;
+}
+
+// ------------------------------------------------------------------
+// Per-request model
+// ------------------------------------------------------------------
+// A write I/O pays the positioning once and then streams its pages: coalescing many
+// dirty pages into one destage is cheaper than writing them one by one, not free
+double LatencyModel::writeCost(long long int writeIOs, long long int writePages) const {
+    return writeIOs * writeLatency + (writePages - writeIOs) * writeTransfer;
+}
+
+double LatencyModel::record(int pages, int hitPages, bool write, long long int writeIOs, long long int writePages) {
+    int missPages = pages - hitPages;
+    double lat;
+
+    if (write) {
+        // The cache is write-back: hits and misses are both absorbed by the cache
+        lat = pages * hitLatency;
+    } else {
+        // Read misses are served by the backing device
+        lat = hitPages * hitLatency + missPages * readLatency;
+    }
+    // Write-back I/Os caused by this request complete before the new pages can be installed
+    lat += writeCost(writeIOs, writePages);
+    return add(lat);
+}
+
+void LatencyModel::setTierLatency(const std::vector<double>& tiers) {
+    tierLatency = tiers;
+}
+
+double LatencyModel::recordTiers(const std::vector<int>& tierHits, int pages, bool write, long long int writeIOs, long long int writePages) {
+    int hitPages = 0;
+    double lat = 0;
+    for (size_t t = 0; t < tierHits.size() && t < tierLatency.size(); t++) {
+        hitPages += tierHits[t];
+        lat += tierHits[t] * tierLatency[t];
+    }
+
+    if (write) {
+        // Writes are absorbed by the top tier
+        lat = pages * tierLatency[0];
+    } else {
+        lat += (pages - hitPages) * readLatency;
+    }
+    lat += writeCost(writeIOs, writePages);
+    return add(lat);
+}
+
+double LatencyModel::add(double lat) {
+    requests++;
+    totalLatency += lat;
+    if (lat > maxLatency) maxLatency = lat;
+    histogram[bucket(lat)]++;
+    return lat;
+}
+
+void LatencyModel::merge(const LatencyModel& other) {
+    for (int b = 0; b <= LATENCY_BUCKETS; b++) histogram[b] += other.histogram[b];
+    requests += other.requests;
+    totalLatency += other.totalLatency;
+    if (other.maxLatency > maxLatency) maxLatency = other.maxLatency;
+}
+
+// ------------------------------------------------------------------
+// Reporting
+// ------------------------------------------------------------------
+void LatencyModel::report(string policy) {
+    double mean = (requests > 0) ? totalLatency / requests : 0.0;
+    double p99 = percentile(0.99);
+    double p999 = percentile(0.999);
+    // One outstanding request at a time: IOPS is the inverse of the mean response time
+    double iops = (mean > 0) ? 1000000.0 / mean : 0.0;
+
+    std::cout << "requests: " << requests << ", meanLatency(us): " << mean << ", p99(us): " << p99 << ", p99.9(us): " << p999 << ", IOPS: " << iops << std::endl;
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << policy << " Latency" << " hitLat " << hitLatency << " readLat " << readLatency << " writeLat " << writeLatency;
+        for (size_t t = 0; t < tierLatency.size(); t++) result << " tier" << t << "Lat " << tierLatency[t];
+        result << " requests " << requests << " meanLatency " << mean << " p99 " << p99 << " p999 " << p999 << " IOPS " << iops << "\n";
+    }
+    result.close();
+}
+
+void LatencyModel::refresh() {
+    histogram.assign(LATENCY_BUCKETS + 1, 0);
+    requests = 0;
+    totalLatency = 0;
+    maxLatency = 0;
+}
@@ -0,0 +1,49 @@
+/* latency.h - Storage device latency model (turns hits/misses into response time and IOPS) */
+#include <string>
+#include <vector>
+using namespace std;
+#ifndef _latency_H
+#define _latency_H
+
+class LatencyModel
+{
+private:
+    // Device parameters, all in microseconds per 4KB page
+    double hitLatency;       // serving a page from the cache (read hit, or a write absorbed by the write-back cache)
+    double readLatency;      // reading a missed page from the backing device
+    double writeLatency;     // one random 4KB write to the backing device (an evictedDirtyPage, or the first page of a destage)
+    double writeTransfer;    // each further page of a coalesced destage, streamed behind the first
+    std::vector<double> tierLatency; // hierarchy mode: serving a page from each tier, top first
+
+    // Response time histogram: bucket i covers [BASE^(i-1), BASE^i) microseconds,
+    // so percentiles are accurate to ~1% without keeping every sample
+    std::vector<long long int> histogram;
+
+    // Statistics
+    long long int requests;
+    double totalLatency;
+    double maxLatency;
+
+    double writeCost(long long int, long long int) const;
+    int bucket(double) const;
+    double percentile(double) const;
+    double add(double);
+
+public:
+    LatencyModel(double, double, double);
+    ~LatencyModel();
+
+    // Estimated response time of one request given its page hits, misses and the write-back I/Os
+    // (and the pages they carried) it caused
+    double record(int pages, int hitPages, bool write, long long int writeIOs, long long int writePages);
+    // Same, for a cache hierarchy: each hit page is charged the latency of the tier that served it
+    void setTierLatency(const std::vector<double>&);
+    double recordTiers(const std::vector<int>& tierHits, int pages, bool write, long long int writeIOs, long long int writePages);
+
+    // Fold in another model's requests (partitioned replay: one model per shard)
+    void merge(const LatencyModel&);
+
+    void report(string policy);
+    void refresh();
+};
+#endif
@@ -0,0 +1,407 @@
+/* lecar.cpp - LeCaR (Learning Cache Replacement) Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <math.h>
+#include "lecar.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+// Both experts start with equal weight; the discount rate makes regret for an
+// eviction fade over roughly one cache's worth of references (Vietri et al.)
+template <class Observer>
+LeCaRCacheT<Observer>::LeCaRCacheT(int n) : rng(1) {
+    csize = n;
+    w_lru = 0.5;
+    w_lfu = 0.5;
+    discount = pow(LECAR_DISCOUNT_BASE, 1.0 / max(1, csize));
+    time = 0;
+    // the two histories share the budget
+    historyLimit = (int)max(1LL, history_cap(2LL * csize) / 2);
+    trimmed = 0;
+
+    // Initialize statistics variables
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    lruEvictions = 0;
+    lfuEvictions = 0;
+    migration = 0;
+    total_migration = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "LeCaR Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << ", Learning rate: " << LECAR_LEARNING_RATE << ", Discount rate: " << discount << std::endl;
+}
+
+template <class Observer>
+LeCaRCacheT<Observer>::~LeCaRCacheT() {
+    recency.clear();
+    freqList.clear();
+    blocks.clear();
+    H_lru.clear();
+    H_lfu.clear();
+    ghost_lru.clear();
+    ghost_lfu.clear();
+}
+
+// ------------------------------------------------------------------
+// LeCaR Helper Functions
+// ------------------------------------------------------------------
+template <class Observer>
+void LeCaRCacheT<Observer>::insert(long long int x, int freq, bool dirty) {
+    recency.push_front(x);
+    // new blocks go to the lowest bucket, found in O(1); only a block coming back
+    // from a history with its old frequency needs a search
+    std::map<int, std::list<long long int> >::iterator it = (freq == 1) ? freqList.begin() : freqList.lower_bound(freq);
+    if (it == freqList.end() || it->first != freq) {
+        it = freqList.emplace_hint(it, freq, std::list<long long int>());
+    }
+    it->second.push_front(x);
+
+    Block b;
+    b.recency = recency.begin();
+    b.bucket = it;
+    b.inBucket = it->second.begin();
+    b.dirty = dirty;
+    blocks[x] = b;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::touch(Block& b) {
+    long long int x = *b.recency;
+    recency.splice(recency.begin(), recency, b.recency);
+
+    // the next bucket up is right after this one, so the hinted insert is O(1)
+    int freq = b.bucket->first + 1;
+    std::map<int, std::list<long long int> >::iterator next = b.bucket;
+    next++;
+    if (next == freqList.end() || next->first != freq) {
+        next = freqList.emplace_hint(next, freq, std::list<long long int>());
+    }
+    next->second.push_front(x);
+    b.bucket->second.erase(b.inBucket);
+    if (b.bucket->second.empty()) freqList.erase(b.bucket);
+    b.bucket = next;
+    b.inBucket = next->second.begin();
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::unlink(long long int x) {
+    Block& b = blocks.at(x);
+    recency.erase(b.recency);
+    b.bucket->second.erase(b.inBucket);
+    if (b.bucket->second.empty()) freqList.erase(b.bucket);
+    blocks.erase(x);
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::evict() {
+    // The victim is chosen by one expert, drawn at random by weight
+    bool byLRU = (double)rng() / ((double)rng.max() + 1.0) < w_lru;
+    long long int victim = byLRU ? recency.back() : freqList.begin()->second.back();
+
+    Block& b = blocks.at(victim);
+    bool dirty = b.dirty;
+    int freq = b.bucket->first;
+    unlink(victim);
+
+    // The expert that chose it keeps it in its history, to be blamed if it comes back
+    if (byLRU) {
+        remember(H_lru, ghost_lru, victim, freq);
+        lruEvictions++;
+    } else {
+        remember(H_lfu, ghost_lfu, victim, freq);
+        lfuEvictions++;
+    }
+
+    if (dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(victim, dirty);
+    observer.evict(victim, dirty);
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::remember(std::list<long long int>& H, std::unordered_map<long long int, Ghost>& ghosts, long long int x, int freq) {
+    H.push_front(x);
+    Ghost g = {H.begin(), time, freq};
+    ghosts[x] = g;
+    if ((int)H.size() > historyLimit) {
+        if ((int)H.size() <= csize) trimmed++;
+        ghosts.erase(H.back());
+        H.pop_back();
+    }
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::forget(std::list<long long int>& H, std::unordered_map<long long int, Ghost>& ghosts, long long int x) {
+    H.erase(ghosts.at(x).pos);
+    ghosts.erase(x);
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::trim_history() {
+    while ((int)H_lru.size() > historyLimit) {
+        ghost_lru.erase(H_lru.back());
+        H_lru.pop_back();
+    }
+    while ((int)H_lfu.size() > historyLimit) {
+        ghost_lfu.erase(H_lfu.back());
+        H_lfu.pop_back();
+    }
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core LeCaR Logic)
+// ------------------------------------------------------------------
+template <class Observer>
+bool LeCaRCacheT<Observer>::refer(long long int x, string rwtype) {
+    calls++;
+    time++;
+
+    // === 1. HIT: both experts' metadata is updated ===
+    typename std::unordered_map<long long int, Block>::iterator it = blocks.find(x);
+    if (it != blocks.end()) {
+        hits++;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
+        if (rwtype == "Write") it->second.dirty = true;
+        touch(it->second);
+        return true;
+    }
+
+    // === 2. MISS: a block found in an expert's history is regret for that expert ===
+    observer.miss(x, rwtype);
+    int freq = 1;
+    if (ghost_lru.count(x)) {
+        observer.ghostHit(x);
+        Ghost& g = ghost_lru.at(x);
+        w_lru *= exp(-LECAR_LEARNING_RATE * pow(discount, (double)(time - g.time)));
+        freq = g.freq + 1;
+        forget(H_lru, ghost_lru, x);
+    } else if (ghost_lfu.count(x)) {
+        observer.ghostHit(x);
+        Ghost& g = ghost_lfu.at(x);
+        w_lfu *= exp(-LECAR_LEARNING_RATE * pow(discount, (double)(time - g.time)));
+        freq = g.freq + 1;
+        forget(H_lfu, ghost_lfu, x);
+    }
+    double total = w_lru + w_lfu;
+    w_lru /= total;
+    w_lfu /= total;
+
+    if ((int)blocks.size() >= csize) {
+        evict();
+    }
+    insert(x, freq, rwtype == "Write");
+    observer.insert(x);
+    migration++;
+    total_migration++;
+    return false;
+}
+
+template <class Observer>
+bool LeCaRCacheT<Observer>::contains(long long int x) {
+    return blocks.count(x) > 0;
+}
+
+template <class Observer>
+bool LeCaRCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // An installed page is no evidence against either expert: drop its history
+    if (ghost_lru.count(x)) forget(H_lru, ghost_lru, x);
+    if (ghost_lfu.count(x)) forget(H_lfu, ghost_lfu, x);
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool LeCaRCacheT<Observer>::remove(long long int x) {
+    typename std::unordered_map<long long int, Block>::iterator it = blocks.find(x);
+    if (it == blocks.end()) return false;
+    // The block leaves without a history entry, it was not evicted by an expert
+    bool dirty = it->second.dirty;
+    unlink(x);
+    return dirty;
+}
+
+template <class Observer>
+long long int LeCaRCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::resize(int n) {
+    csize = n;
+    discount = pow(LECAR_DISCOUNT_BASE, 1.0 / max(1, csize));
+    while ((int)blocks.size() > csize) {
+        evict();
+    }
+    // the histories shrink with the cache
+    historyLimit = (int)max(1LL, history_cap(2LL * csize) / 2);
+    trim_history();
+}
+
+// ------------------------------------------------------------------
+// Snapshot: weights, clock and generator state, the resident blocks from the
+// LRU end with their frequencies, then both histories oldest first
+// ------------------------------------------------------------------
+template <class Observer>
+bool LeCaRCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "LeCaR", csize);
+    snap_put(out, w_lru);
+    snap_put(out, w_lfu);
+    snap_put(out, time);
+    std::ostringstream state;
+    state << rng;
+    string s = state.str();
+    snap_put(out, (long long int)s.size());
+    out.write(s.data(), s.size());
+
+    snap_put(out, (long long int)recency.size());
+    for (std::list<long long int>::reverse_iterator it = recency.rbegin(); it != recency.rend(); it++) {
+        const Block& b = blocks.at(*it);
+        snap_put_entry(out, *it, b.dirty);
+        snap_put(out, b.bucket->first);
+    }
+    std::list<long long int>* histories[2] = {&H_lru, &H_lfu};
+    std::unordered_map<long long int, Ghost>* ghosts[2] = {&ghost_lru, &ghost_lfu};
+    for (int h = 0; h < 2; h++) {
+        snap_put(out, (long long int)histories[h]->size());
+        for (std::list<long long int>::reverse_iterator it = histories[h]->rbegin(); it != histories[h]->rend(); it++) {
+            const Ghost& g = ghosts[h]->at(*it);
+            snap_put(out, *it);
+            snap_put(out, g.time);
+            snap_put(out, g.freq);
+        }
+    }
+    return (bool)out;
+}
+
+template <class Observer>
+bool LeCaRCacheT<Observer>::load(std::istream& in) {
+    long long int length = 0;
+    if (!snap_check(in, "LeCaR", csize) || !snap_get(in, w_lru) || !snap_get(in, w_lfu) || !snap_get(in, time) || !snap_get(in, length)) return false;
+    string s(length, '\0');
+    if (length > 0) in.read(&s[0], length);
+    std::istringstream state(s);
+    state >> rng;
+
+    recency.clear();
+    freqList.clear();
+    blocks.clear();
+    H_lru.clear();
+    H_lfu.clear();
+    ghost_lru.clear();
+    ghost_lfu.clear();
+
+    // inserting from the LRU end rebuilds the recency list and the order within each bucket
+    long long int n = 0;
+    if (!snap_get(in, n)) return false;
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        int freq;
+        if (!snap_get_entry(in, x, dirty) || !snap_get(in, freq)) return false;
+        insert(x, freq, dirty);
+    }
+    std::list<long long int>* histories[2] = {&H_lru, &H_lfu};
+    std::unordered_map<long long int, Ghost>* ghosts[2] = {&ghost_lru, &ghost_lfu};
+    for (int h = 0; h < 2; h++) {
+        if (!snap_get(in, n)) return false;
+        for (long long int i = 0; i < n; i++) {
+            long long int x;
+            long long int evicted;
+            int freq;
+            if (!snap_get(in, x) || !snap_get(in, evicted) || !snap_get(in, freq)) return false;
+            remember(*histories[h], *ghosts[h], x, freq);
+            ghosts[h]->at(x).time = evicted;
+        }
+    }
+    return (bool)in;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int LeCaRCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Each miss may move the weights that choose the next victim,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+
+// ------------------------------------------------------------------
+// Remaining Required Methods
+// ------------------------------------------------------------------
+template <class Observer>
+void LeCaRCacheT<Observer>::display() {
+	std::cout << "LeCaR Cache displayed." << std::endl;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "wLRU: " << w_lru << ", wLFU: " << w_lfu << ", lruEvictions: " << lruEvictions << ", lfuEvictions: " << lfuEvictions << std::endl;
+
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result <<  "LeCaR " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " wLRU " << w_lru << " wLFU " << w_lfu << " lruEvictions " << lruEvictions << " lfuEvictions " << lfuEvictions << "\n" ;
+	}
+	result.close();
+	report_budget("LeCaR", (long long int)(H_lru.size() + H_lfu.size()), trimmed);
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::refresh(){
+	calls = 0;
+	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	lruEvictions = 0;
+	lfuEvictions = 0;
+	trimmed = 0;
+	migration = 0;
+}
+
+template <class Observer>
+void LeCaRCacheT<Observer>::summary() {
+	// print the number of total cache calls, hits, and data migration size
+}
+
+// The observers the simulator is built with (observer.h)
+template class LeCaRCacheT<NullObserver>;
+template class LeCaRCacheT<EventRecorder>;
@@ -0,0 +1,99 @@
+/* lecar.h - LeCaR (Learning Cache Replacement) Cache Policy: regret-weighted LRU and LFU experts */
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <map>
+#include <random>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "budget.h"
+using namespace std;
+#ifndef _lecar_H
+#define _lecar_H
+
+#define LECAR_LEARNING_RATE 0.45 // lambda of the weight update
+#define LECAR_DISCOUNT_BASE 0.005 // the discount rate is DISCOUNT_BASE^(1/C)
+
+template <class Observer = NullObserver>
+class LeCaRCacheT
+{
+private:
+    int csize; // Maximum capacity of the cache (C)
+
+    // Resident blocks carry the metadata of both experts: a place in the recency
+    // list (LRU) and in a frequency bucket (LFU, least recent last within a bucket)
+    struct Block {
+        std::list<long long int>::iterator recency;
+        std::map<int, std::list<long long int> >::iterator bucket;
+        std::list<long long int>::iterator inBucket;
+        bool dirty;
+    };
+    std::list<long long int> recency;                  // MRU first
+    std::map<int, std::list<long long int> > freqList; // frequency -> keys, MRU first
+    std::unordered_map<long long int, Block> blocks;
+
+    // Each expert's history of the blocks it evicted, newest first, at most C each
+    struct Ghost {
+        std::list<long long int>::iterator pos;
+        long long int time; // when the block was evicted
+        int freq;           // its frequency, restored if it comes back
+    };
+    std::list<long long int> H_lru;
+    std::list<long long int> H_lfu;
+    std::unordered_map<long long int, Ghost> ghost_lru;
+    std::unordered_map<long long int, Ghost> ghost_lfu;
+    int historyLimit;      // entries per history: C, or half the metadata budget if smaller
+    long long int trimmed; // history entries dropped because of the budget
+
+    // Expert weights (w_lru + w_lfu = 1) and their update parameters
+    double w_lru;
+    double w_lfu;
+    double discount;
+    long long int time; // references seen, the clock of the histories
+    std::mt19937 rng;   // fixed seed, so a replay is reproducible
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int lruEvictions; // victims chosen by the LRU expert
+    long long int lfuEvictions; // victims chosen by the LFU expert
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
+    long long int migration, total_migration;
+
+    // Helper functions for the LeCaR policy
+    void insert(long long int, int, bool);
+    void touch(Block&);
+    void unlink(long long int);
+    void evict();
+    void remember(std::list<long long int>&, std::unordered_map<long long int, Ghost>&, long long int, int);
+    void forget(std::list<long long int>&, std::unordered_map<long long int, Ghost>&, long long int);
+    void trim_history();
+
+public:
+    LeCaRCacheT(int);
+    ~LeCaRCacheT();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts through the experts
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+
+typedef LeCaRCacheT<> LeCaRCache;
+#endif
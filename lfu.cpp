@@ -16,7 +16,8 @@ using namespace std;
 // ------------------------------------------------------------------
 // Constructor
 // ------------------------------------------------------------------
-LFUCache::LFUCache(int n) {
+template <class Observer>
+LFUCacheT<Observer>::LFUCacheT(int n, bool verbose) : keyFreq(arena.map<int>()), keyIterMap(arena.map<KeyList::iterator>()), accessType(arena.map<string>()) {
 	csize = n;
 	hits = 0;	
 	total_hits = 0;
@@ -28,15 +29,20 @@ LFUCache::LFUCache(int n) {
 	readHits = 0; 
 	writeHits = 0; 
 	evictedDirtyPage = 0; 
+	sink = NULL;
+	page_size = PAGE_SIZE;
 	
-	std::cout << "LFU Algorithm is used" << std::endl;
-	std::cout << "Cache size is: " << csize <<  std::endl;
+	if (verbose) {
+		std::cout << "LFU Algorithm is used" << std::endl;
+		std::cout << "Cache size is: " << csize <<  std::endl;
+	}
 }
 
 // ------------------------------------------------------------------
 // Destructor (Fixes Undefined symbol: LFUCache::~LFUCache())
 // ------------------------------------------------------------------
-LFUCache::~LFUCache() {
+template <class Observer>
+LFUCacheT<Observer>::~LFUCacheT() {
 	csize = 0;
 	hits = 0;	
 	total_hits = 0;
@@ -56,52 +62,75 @@ LFUCache::~LFUCache() {
 	accessType.clear(); 
 }
 
+template <class Observer>
+KeyList& LFUCacheT<Observer>::keysAt(int freq) {
+    map<int, KeyList>::iterator it = freqList.find(freq);
+    if (it == freqList.end()) it = freqList.insert(std::make_pair(freq, arena.list())).first;
+    return it->second;
+}
+
+// ------------------------------------------------------------------
+// Eviction: the least frequently used key, least recently used among equals
+// ------------------------------------------------------------------
+template <class Observer>
+void LFUCacheT<Observer>::evict() {
+    // 1. Find the list corresponding to the minimum frequency (first entry in std::map)
+    auto it_min_freq = freqList.begin();
+    
+    // 2. The key to evict is the *last* element in this list (LRU tie-breaker for LFU)
+    long long int last = it_min_freq->second.back(); 
+    
+    // 3. Remove the key from all data structures
+    it_min_freq->second.pop_back(); // Remove from the list of keys at min frequency
+    keyIterMap.erase(last);         // Remove from the key iterator map
+    keyFreq.erase(last);            // Remove from the key frequency map
+
+    // Handle dirty page eviction (same as LRU)
+    bool dirty = (accessType[last] == "Write");
+    if(dirty){
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(last, dirty);
+    observer.evict(last, dirty);
+    accessType.erase(last); // Erase the access type of the evicted page
+    
+    // 4. Cleanup: If the list for the minimum frequency is now empty, remove the frequency entry
+    if (it_min_freq->second.empty()) {
+        freqList.erase(it_min_freq);
+    }
+}
+
 // ------------------------------------------------------------------
 // Refer Method (Core LFU Logic)
 // ------------------------------------------------------------------
-void LFUCache::refer(long long int x, string rwtype) {
+template <class Observer>
+bool LFUCacheT<Observer>::refer(long long int x, string rwtype) {
     calls++;
     
     int currentFreq = 0;
+    bool hit = false;
     
     // Case 1: Key is NOT in the cache (MISS)
     if (keyFreq.find(x) == keyFreq.end()) {
+        observer.miss(x, rwtype);
         
         // If cache is FULL, we must evict
         if (keyIterMap.size() == csize) {
-            
-            // 1. Find the list corresponding to the minimum frequency (first entry in std::map)
-            auto it_min_freq = freqList.begin();
-            
-            // 2. The key to evict is the *last* element in this list (LRU tie-breaker for LFU)
-            long long int last = it_min_freq->second.back(); 
-            
-            // 3. Remove the key from all data structures
-            it_min_freq->second.pop_back(); // Remove from the list of keys at min frequency
-            keyIterMap.erase(last);         // Remove from the key iterator map
-            keyFreq.erase(last);            // Remove from the key frequency map
-
-            // Handle dirty page eviction (same as LRU)
-            if(accessType[last] == "Write"){
-                evictedDirtyPage++;             
-            }
-            accessType.erase(last); // Erase the access type of the evicted page
-            
-            // 4. Cleanup: If the list for the minimum frequency is now empty, remove the frequency entry
-            if (it_min_freq->second.empty()) {
-                freqList.erase(it_min_freq);
-            }
+            evict();
         }
         
         // Insert the new key: It starts with frequency 1.
         currentFreq = 1;
         keyFreq[x] = currentFreq;
         accessType[x] = rwtype; // Store access type
+        observer.insert(x);
         
     } 
     // Case 2: Key IS in the cache (HIT)
     else {
         hits++;
+        hit = true;
+        observer.hit(x, rwtype);
         
         // 1. Get the current frequency and the iterator to the key's position
         currentFreq = keyFreq[x];
@@ -130,16 +159,165 @@ void LFUCache::refer(long long int x, string rwtype) {
     
     // Insert the key into its NEW (or starting) frequency list (currentFreq)
     // We insert at the front (Most Recently Used for this frequency)
-    freqList[currentFreq].push_front(x);
+    KeyList& keys = keysAt(currentFreq);
+    keys.push_front(x);
     
     // Update the key's iterator to point to its new position
-    keyIterMap[x] = freqList[currentFreq].begin();
+    keyIterMap[x] = keys.begin();
+    return hit;
+}
+
+template <class Observer>
+bool LFUCacheT<Observer>::contains(long long int x) {
+    return keyFreq.find(x) != keyFreq.end();
+}
+
+template <class Observer>
+bool LFUCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool LFUCacheT<Observer>::remove(long long int x) {
+    if (keyFreq.find(x) == keyFreq.end()) return false;
+    int freq = keyFreq[x];
+    freqList[freq].erase(keyIterMap[x]);
+    if (freqList[freq].empty()) {
+        freqList.erase(freq);
+    }
+    keyIterMap.erase(x);
+    keyFreq.erase(x);
+    bool dirty = (accessType[x] == "Write");
+    accessType.erase(x);
+    return dirty;
+}
+
+template <class Observer>
+long long int LFUCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void LFUCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void LFUCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void LFUCacheT<Observer>::resize(int n) {
+    csize = n;
+    while (keyIterMap.size() > csize) {
+        evict();
+    }
+}
+
+template <class Observer>
+void LFUCacheT<Observer>::residents(std::vector<std::pair<long long int, bool> >& out) {
+    out.clear();
+    for (map<int, KeyList>::iterator f = freqList.begin(); f != freqList.end(); f++) {
+        for (KeyList::reverse_iterator it = f->second.rbegin(); it != f->second.rend(); it++) {
+            out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
+        }
+    }
+}
+
+// Snapshot: every key with its frequency and dirty bit, in frequency order and
+// MRU to LRU within a frequency, so ties break the same way after a restore
+template <class Observer>
+bool LFUCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "LFU", csize);
+    snap_put(out, (long long int)keyFreq.size());
+    for (map<int, KeyList>::iterator f = freqList.begin(); f != freqList.end(); f++) {
+        for (KeyList::iterator it = f->second.begin(); it != f->second.end(); it++) {
+            snap_put_entry(out, *it, accessType[*it] == "Write");
+            snap_put(out, f->first);
+        }
+    }
+    return (bool)out;
+}
+
+template <class Observer>
+bool LFUCacheT<Observer>::load(std::istream& in) {
+    long long int n = 0;
+    if (!snap_check(in, "LFU", csize) || !snap_get(in, n)) return false;
+    freqList.clear();
+    keyIterMap.clear();
+    keyFreq.clear();
+    accessType.clear();
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        int freq;
+        if (!snap_get_entry(in, x, dirty) || !snap_get(in, freq)) return false;
+        KeyList& keys = keysAt(freq);
+        keys.push_back(x);
+        keyIterMap[x] = --keys.end();
+        keyFreq[x] = freq;
+        accessType[x] = dirty ? "Write" : "Read";
+    }
+    return true;
+}
+
+// Batched references: the lookups of the whole batch are issued before the first update,
+// so their cache misses overlap instead of each one stalling the next; the updates then
+// run in order through refer(), so the result is that of referring the keys one by one.
+template <class Observer>
+void LFUCacheT<Observer>::prefetch(const long long int* keys, int n) {
+    if (keyIterMap.size() < PREFETCH_MIN_KEYS) return;
+    prefetch_buckets(keyFreq, keys, n, batch_buckets);
+    prefetch_buckets(keyIterMap, keys, n, batch_buckets);
+    prefetch_buckets(accessType, keys, n, batch_buckets);
+    for (int i = 0; i < n; i++) {
+        KeyMap<KeyList::iterator>::const_iterator it = keyIterMap.find(keys[i]);
+        // the list node is moved on a hit
+        if (it != keyIterMap.end()) __builtin_prefetch(&*it->second, 1);
+    }
+}
+
+template <class Observer>
+int LFUCacheT<Observer>::refer_batch(const long long int* keys, const string* ops, int n, char* hit, long long int* dirty) {
+    prefetch(keys, n);
+    int hitKeys = 0;
+    for (int i = 0; i < n; i++) {
+        long long int before = evictedDirtyPage;
+        bool h = refer(keys[i], ops[i]);
+        if (hit) hit[i] = h;
+        if (dirty) dirty[i] = evictedDirtyPage - before;
+        hitKeys += h;
+    }
+    return hitKeys;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int LFUCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Frequency lists shift as earlier pages of the run are inserted or evicted,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
 }
 
 // ------------------------------------------------------------------
 // Cache Hits Summary (Fixes Undefined symbol: LFUCache::cachehits())
 // ------------------------------------------------------------------
-void LFUCache::cachehits() {
+template <class Observer>
+void LFUCacheT<Observer>::cachehits() {
     
     float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
 
@@ -155,7 +333,8 @@ void LFUCache::cachehits() {
 // ------------------------------------------------------------------
 // Other required methods (Copied from LRU structure)
 // ------------------------------------------------------------------
-void LFUCache::display() {
+template <class Observer>
+void LFUCacheT<Observer>::display() {
 	// print the cached key after program terminate 
     // This is complex for LFU, so we can skip printing keys for brevity, or iterate:
 	// for (auto const& [freq, list_of_keys] : freqList) {
@@ -166,17 +345,26 @@ void LFUCache::display() {
 	std::cout << "LFU Cache displayed." << std::endl;
 }
 
-void LFUCache::refresh(){
-	//when a new query is start, reset the "calls", "hits", and "migration" to zero
+template <class Observer>
+void LFUCacheT<Observer>::refresh(){
+	//when a new query (or the measured phase after warmup) starts, reset every per-run counter to zero
 	calls = 0;
 	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
 	migration = 0;
 }
 
-void LFUCache::summary() {
+template <class Observer>
+void LFUCacheT<Observer>::summary() {
 	// print the number of total cache calls, hits, and data migration size
 	std::cout << "the total number of cache hits is: " << total_hits << std::endl;
 	std::cout << "the total number of total refered calls is " << total_calls << std::endl;
 	std::cout << "the total data migration size into the optane is: " << ((double)total_migration) * 16 / 1024/ 1024 << "GB" << std::endl;
 
-}
\ No newline at end of file
+}
+
+// The observers the simulator is built with (observer.h)
+template class LFUCacheT<NullObserver>;
+template class LFUCacheT<EventRecorder>;
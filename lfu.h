@@ -3,44 +3,76 @@
 #include <unordered_map>
 #include <list>
 #include <map> // We will use std::map to organize by frequency
+#include <vector>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "arena.h"
 using namespace std; 
 #ifndef _lfu_H
 #define _lfu_H
 
-class LFUCache
+template <class Observer = NullObserver>
+class LFUCacheT
 {
 private:
+    // with -G the lists and maps below are carved from it, so it outlives them
+    MetadataArena arena;
+
     int csize; // maximum capacity of cache
     
     // 1. Tracks the frequency of each key (block address)
-    unordered_map<long long int, int> keyFreq; 
+    KeyMap<int> keyFreq; 
     
     // 2. Tracks the key's position in the frequency list. 
     //    It maps key -> iterator to its position in freqList's std::list<long long int>
     //    This is analogous to LRU's 'ma' mapping key to its position in the list.
-    unordered_map<long long int, list<long long int>::iterator> keyIterMap;
+    KeyMap<KeyList::iterator> keyIterMap;
     
     // 3. Organizes keys by frequency. 
     //    The outer map: frequency (int) -> a list of keys (long long int) that have that frequency.
     //    The inner list is an LRU for keys with the same frequency.
-    map<int, list<long long int>> freqList; 
+    map<int, KeyList> freqList; 
     
     // Statistics (Copy from lru.h)
-    unordered_map<long long int, string> accessType; 
+    KeyMap<string> accessType; 
     long long int calls, total_calls;
     long long int hits, total_hits;
     long long int readHits; 
     long long int writeHits; 
     long long int evictedDirtyPage; 
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
     long long int migration, total_migration;
 
+    std::vector<size_t> batch_buckets; // scratch space for prefetch: each key's bucket
+
+    void evict();
+    KeyList& keysAt(int freq); // the list of keys at freq, created empty from the arena
+
 public:
-    LFUCache(int);
-    ~LFUCache();
-    void refer(long long int, string);
+    LFUCacheT(int, bool verbose = true);
+    ~LFUCacheT();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    void prefetch(const long long int*, int); // brings the metadata of these keys into the CPU cache, changes nothing
+    int refer_batch(const long long int*, const string*, int, char* hit = NULL, long long int* dirty = NULL); // refer each key in order after prefetching them all, returns the hits; dirty: dirty victims per key
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts the least frequently used end
+    void residents(std::vector<std::pair<long long int, bool> >&); // resident keys and dirty bits, least frequently used first
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
     void display();
     void cachehits();
     void refresh();
     void summary();
 };
-#endif
\ No newline at end of file
+
+typedef LFUCacheT<> LFUCache;
+#endif
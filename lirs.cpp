@@ -4,18 +4,29 @@
 #include <fstream>
 #include <ctime>
 #include <algorithm>
+#include <climits>
 #include "lirs.h" // Include your new header
 using namespace std; 
 
+bool LIRSDefaults::compactGhosts = false;
+
 // ------------------------------------------------------------------
 // Constructor and Destructor
 // ------------------------------------------------------------------
-LIRSCache::LIRSCache(int n) {
+template <class Observer>
+LIRSCacheT<Observer>::LIRSCacheT(int n, bool verbose) : R(arena.list()), R_map(arena.map<KeyList::iterator>()), resident_map(arena.map<bool>()), LIR_set(arena.set()), HIR_resident_list(arena.list()), Q_map(arena.map<KeyList::iterator>()),
+    key_status_map(arena.map<Status>()), compact(compactGhosts), nonresident(compactGhosts ? history_cap(n) : 0, true), ref_time(arena.map<uint32_t>()), accessType(arena.map<string>()) {
     csize = n;
+    clock = 0;
+    nonresident_count = 0;
+    historyLimit = history_cap(compact ? csize : LLONG_MAX);
+    trimmed = 0;
+    falseGhostHits = 0;
     // LIRS uses a split size; setting lir_size to 1% of csize is a common starting point
     // but the LIRS paper often sets the maximum LIR size based on the total number of blocks (L)
-    // For simplicity, we can use a small fixed percentage of csize.
-    lir_size = max(1, (int)(csize * 0.01)); 
+    // For simplicity, we can use a small fixed percentage of csize (auto-tuning moves it, see tuner.h).
+    lir_fraction = 0.01;
+    lir_size = max(1, (int)(csize * lir_fraction)); 
 
     // Initialize statistics variables
     hits = 0;	
@@ -23,172 +34,547 @@ LIRSCache::LIRSCache(int n) {
     readHits = 0; 
     writeHits = 0; 
     evictedDirtyPage = 0; 
+    sink = NULL;
+    page_size = PAGE_SIZE;
     
-    std::cout << "LIRS Algorithm is used" << std::endl;
-	std::cout << "Cache size: " << csize << ", LIR size: " << lir_size << std::endl;
+    if (verbose) {
+        std::cout << "LIRS Algorithm is used" << std::endl;
+        std::cout << "Cache size: " << csize << ", LIR size: " << lir_size << (compact ? ", Non-resident history: fingerprints" : "") << std::endl;
+    }
 }
 
-LIRSCache::~LIRSCache() {
+template <class Observer>
+LIRSCacheT<Observer>::~LIRSCacheT() {
     R.clear();
     R_map.clear();
     resident_map.clear();
     LIR_set.clear();
-    HIR_nonresident_list.clear();
+    HIR_resident_list.clear();
+    Q_map.clear();
     key_status_map.clear();
     accessType.clear();
+    ref_time.clear();
     // Reset all stat variables...
 }
 
+template <class Observer>
+void LIRSCacheT<Observer>::setCompactGhosts(bool on) {
+    compactGhosts = on;
+}
+
 // ------------------------------------------------------------------
-// LIRS Helper Functions (Stubs for the main logic)
+// LIRS Helper Functions
 // ------------------------------------------------------------------
 
-void LIRSCache::prune_stack() {
-    // Prune the R-Stack (R) by removing the tail items until the first HIR item is reached.
+template <class Observer>
+long long int LIRSCacheT<Observer>::ghost_size() {
+    return compact ? nonresident.size() : nonresident_count;
+}
+
+template <class Observer>
+int LIRSCacheT<Observer>::getCapacity() {
+    return csize;
+}
+
+template <class Observer>
+bool LIRSCacheT<Observer>::hasCompactGhosts() {
+    return compact;
+}
+
+template <class Observer>
+long long int LIRSCacheT<Observer>::getGhostBytes() {
+    return ghost_bytes();
+}
+
+template <class Observer>
+long long int LIRSCacheT<Observer>::getFalseGhostHits() {
+    return falseGhostHits;
+}
+
+template <class Observer>
+long long int LIRSCacheT<Observer>::ghost_bytes() {
+    // compact mode pays for the filter and a stamp per resident block
+    if (compact) return nonresident.bytes() + (long long int)ref_time.size() * map_entry_bytes(sizeof(uint32_t));
+    // a stack node and two map entries (R_map, key_status_map) per non-resident block
+    long long int entry = list_entry_bytes() + map_entry_bytes(sizeof(KeyList::iterator)) + map_entry_bytes(sizeof(Status));
+    return ghost_size() * entry;
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::prune_stack() {
+    // Prune the R-Stack (R) by removing the tail items until the first LIR item is reached,
+    // so the bottom of R is always the LIR block with the largest recency.
     while (!R.empty()) {
         long long int key = R.back();
         // If the key is LIR, stop pruning
         if (key_status_map.at(key) == LIR) {
             break;
         }
-        // If the key is a resident HIR, we should not remove it from the cache, just the stack
-        
-        // However, the standard implementation of LIRS often only requires removing non-resident HIR pages.
-        // For the full LIRS, pages in R are unique. If we hit the first LIR from the back, we stop.
-        // We only remove the key from the R-Stack if it's NOT LIR.
         R.pop_back();
         R_map.erase(key);
-        // Note: The key still retains its LIR/HIR status and may still be in the cache.
+        // A resident HIR block stays in Q; a non-resident one has no history left and is forgotten
+        if (key_status_map.at(key) == NON_RESIDENT_HIR) {
+            key_status_map.erase(key);
+            nonresident_count--;
+        }
     }
 }
 
-void LIRSCache::evict_HIR_block() {
-    // Evicts the page with the lowest recency from the HIR resident set (usually the tail of the resident HIR list).
-    // In this simplified structure, we look at the R-stack bottom.
-    
-    // Find a resident HIR block to evict. The key is to find the one with the largest recency (furthest from the top of R).
-    // The standard LIRS uses a list B (or the non-resident HIR list) for this, but to keep the implementation simple, 
-    // we use the HIR_nonresident_list as the candidate pool. Evict the key at the *head* of this list.
-    
-    if (HIR_nonresident_list.empty()) {
-        // Should not happen if the policy is working and the cache is full
+template <class Observer>
+void LIRSCacheT<Observer>::evict_HIR_block() {
+    // Evicts the resident HIR block at the front of Q.
+    if (HIR_resident_list.empty()) {
+        // Every resident block is LIR (only when lir_size fills the cache): make room in Q first
+        adjust_LIR_size();
+    }
+    if (HIR_resident_list.empty()) {
         return;
     }
     
-    long long int victim = HIR_nonresident_list.front();
+    long long int victim = HIR_resident_list.front();
+    HIR_resident_list.pop_front();
+    Q_map.erase(victim);
     
-    // 1. Remove from cache (implicit by clearing status and resident_map)
+    // 1. Remove from cache
     resident_map.erase(victim);
     
-    // 2. Update status (set to non-resident HIR)
-    key_status_map[victim] = NON_RESIDENT_HIR;
-    
-    // 3. Keep victim key in HIR_nonresident_list for history tracking
+    // 2. Still in R: keep its recency as a non-resident HIR block, otherwise forget it
+    if (compact) {
+        if (R_map.count(victim)) {
+            R.erase(R_map.at(victim));
+            R_map.erase(victim);
+            if (historyLimit < csize && nonresident.size() >= historyLimit) {
+                nonresident.pop();
+                trimmed++;
+            }
+            nonresident.insert(victim, ref_time.at(victim));
+        }
+        key_status_map.erase(victim);
+        ref_time.erase(victim);
+    } else if (R_map.count(victim)) {
+        key_status_map[victim] = NON_RESIDENT_HIR;
+        if (++nonresident_count > historyLimit) trim_history();
+    } else {
+        key_status_map.erase(victim);
+    }
     
     // If the evicted page was written to, count it as dirty
-    if(accessType.count(victim) && accessType.at(victim) == "Write"){
-        evictedDirtyPage++;             
+    bool dirty = (accessType.count(victim) && accessType.at(victim) == "Write");
+    if(dirty){
+        evictedDirtyPage++;
     }
+    if (sink) sink->evicted(victim, dirty);
+    observer.evict(victim, dirty);
     accessType.erase(victim);
-    
-    // *** NOTE: The full LIRS implementation requires adjusting the LIR/HIR sizes and promoting/demoting pages. ***
 }
 
-void LIRSCache::adjust_LIR_size() {
-    // If a non-resident HIR is promoted to LIR, a LIR page must be demoted to HIR.
-    // The LIR page to demote is the one at the bottom of the R-stack (first LIR element from the bottom)
-    // This is the most complex part of LIRS and usually involves a search from the tail of R.
+template <class Observer>
+void LIRSCacheT<Observer>::trim_history() {
+    // Over the metadata budget: drop the non-resident blocks deepest in R, the ones
+    // stack pruning would have forgotten next. Trimming goes an eighth below the cap,
+    // so the walk past the resident blocks near the bottom is paid once per slice.
+    long long int target = historyLimit - max(1LL, historyLimit / 8);
+    KeyList::iterator it = R.end();
+    while (nonresident_count > target && it != R.begin()) {
+        --it;
+        if (key_status_map.at(*it) != NON_RESIDENT_HIR) continue;
+        long long int key = *it;
+        it = R.erase(it);
+        R_map.erase(key);
+        key_status_map.erase(key);
+        nonresident_count--;
+        trimmed++;
+    }
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::adjust_LIR_size() {
+    // A block promoted to LIR makes the LIR block at the bottom of the R-stack (the LIR block
+    // with the largest recency) a resident HIR block at the end of Q.
+    if (R.empty() || key_status_map.at(R.back()) != LIR) {
+        return;
+    }
+    long long int bottom = R.back();
+    R.pop_back();
+    R_map.erase(bottom);
+    LIR_set.erase(bottom);
+    key_status_map[bottom] = RESIDENT_HIR;
+    HIR_resident_list.push_back(bottom);
+    Q_map[bottom] = --HIR_resident_list.end();
+    prune_stack();
 }
 
 // ------------------------------------------------------------------
 // Refer Method (High-Level LIRS Logic)
 // ------------------------------------------------------------------
-void LIRSCache::refer(long long int x, string rwtype) {
+template <class Observer>
+bool LIRSCacheT<Observer>::refer(long long int x, string rwtype) {
     calls++;
+    clock++;
+    bool hit = false;
 
-    // 1. Update R-Stack: Remove x from its current position in R (if it exists)
-    if (R_map.count(x)) {
-        R.erase(R_map.at(x));
-        R_map.erase(x);
-    }
-    // Add x to the top of R (Most Recently Referenced)
-    R.push_front(x);
-    R_map[x] = R.begin();
-    
     // Check if x is in cache (resident_map)
     if (resident_map.count(x)) {
         hits++;
+        hit = true;
         // Update stats
         (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
         if (rwtype == "Write") accessType[x] = "Write";
 
+        bool in_stack = R_map.count(x) > 0;
+        // Move x to the top of R (Most Recently Referenced)
+        if (in_stack) {
+            R.erase(R_map.at(x));
+        }
+        R.push_front(x);
+        R_map[x] = R.begin();
+        if (compact) ref_time[x] = clock;
+
         // LIRS State Transitions (HIT):
-        if (key_status_map.at(x) == LIR) {
-            // LIR HIT: Already LIR, no state change. Prune the R-Stack.
-            prune_stack();
-        } else if (key_status_map.at(x) == RESIDENT_HIR) {
-            // RESIDENT HIR HIT: Promote to LIR if IR of x is small (not done here for brevity)
-            // A simple implementation promotes if the cache is below capacity.
-            // Full LIRS requires checking the LIR set size limit.
-            
-            // For now, simple promotion if LIR size is not exceeded:
-            if (LIR_set.size() < lir_size) {
-                 key_status_map[x] = LIR;
-                 LIR_set.insert(x);
-                 // Demotion/Adjustment would happen in adjust_LIR_size, but required here for promotion.
-                 prune_stack();
+        if (key_status_map.at(x) == RESIDENT_HIR) {
+            if (in_stack) {
+                // RESIDENT HIR HIT inside R: its new IRR is smaller than the recency of the
+                // bottom LIR block, so x becomes LIR and that block is demoted
+                HIR_resident_list.erase(Q_map.at(x));
+                Q_map.erase(x);
+                key_status_map[x] = LIR;
+                LIR_set.insert(x);
+                observer.promote(x);
+                adjust_LIR_size();
             } else {
-                // Stay resident HIR
+                // Stays resident HIR, moves to the end of Q
+                HIR_resident_list.splice(HIR_resident_list.end(), HIR_resident_list, Q_map.at(x));
             }
         }
+        // x may have been the bottom of R
+        prune_stack();
     } else {
         // MISS: Block x is NOT in cache
+        observer.miss(x, rwtype);
         
-        // 1. Eviction: If cache is full, evict a block
-        if (resident_map.size() == csize) {
-            // Evict an HIR block (evict_HIR_block handles LIR size adjustment/demotion implicitly)
+        // 1. Eviction: If cache is full, evict the resident HIR block at the front of Q
+        if (resident_map.size() >= csize) {
             evict_HIR_block();
         }
-        
-        // 2. Insertion: Insert x into cache as Resident HIR
+
+        // 2. x is still in R as a non-resident HIR block if it was referenced recently
+        bool in_stack = false;
+        uint32_t last;
+        if (!compact) {
+            in_stack = R_map.count(x) > 0;
+            if (in_stack) {
+                R.erase(R_map.at(x));
+                nonresident_count--;
+            }
+        } else if (nonresident.find(x, last)) {
+            // referenced after the bottom LIR block (wrap-around safe), else pruned long ago
+            in_stack = !R.empty() && (int32_t)(last - ref_time.at(R.back())) > 0;
+            if (in_stack && !nonresident.verify(x)) falseGhostHits++;
+            nonresident.erase(x);
+        }
+        if (in_stack) observer.ghostHit(x);
+        R.push_front(x);
+        R_map[x] = R.begin();
+        if (compact) ref_time[x] = clock;
         resident_map[x] = true;
-        key_status_map[x] = RESIDENT_HIR; 
-        
-        // Update access type for the new block
         accessType[x] = rwtype;
+
+        // 3. Insertion: LIR while the LIR set is not full, or when the recent history makes
+        //    its IRR smaller than the bottom LIR block's recency; resident HIR otherwise
+        if (LIR_set.size() < lir_size) {
+            key_status_map[x] = LIR;
+            LIR_set.insert(x);
+        } else if (in_stack) {
+            key_status_map[x] = LIR;
+            LIR_set.insert(x);
+            adjust_LIR_size();
+        } else {
+            key_status_map[x] = RESIDENT_HIR;
+            HIR_resident_list.push_back(x);
+            Q_map[x] = --HIR_resident_list.end();
+        }
+        observer.insert(x);
+    }
+    return hit;
+}
+
+template <class Observer>
+bool LIRSCacheT<Observer>::contains(long long int x) {
+    return resident_map.count(x) > 0;
+}
+
+template <class Observer>
+bool LIRSCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool LIRSCacheT<Observer>::remove(long long int x) {
+    if (!resident_map.count(x)) return false;
+    // Forget the block entirely: residency, LIR status, its place in Q and in the R-Stack
+    resident_map.erase(x);
+    LIR_set.erase(x);
+    key_status_map.erase(x);
+    if (Q_map.count(x)) {
+        HIR_resident_list.erase(Q_map.at(x));
+        Q_map.erase(x);
+    }
+    if (R_map.count(x)) {
+        R.erase(R_map.at(x));
+        R_map.erase(x);
+    }
+    ref_time.erase(x);
+    prune_stack();
+    bool dirty = (accessType.count(x) && accessType.at(x) == "Write");
+    accessType.erase(x);
+    return dirty;
+}
+
+template <class Observer>
+long long int LIRSCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::setLIRFraction(double f) {
+    lir_fraction = f;
+    lir_size = max(1, (int)(csize * lir_fraction));
+    // surplus LIR blocks are demoted to Q, from the bottom of R; a larger target
+    // fills up as missed blocks enter the LIR set
+    while (LIR_set.size() > lir_size && !R.empty() && key_status_map.at(R.back()) == LIR) {
+        adjust_LIR_size();
+    }
+}
+
+template <class Observer>
+double LIRSCacheT<Observer>::getLIRFraction() {
+    return lir_fraction;
+}
+
+template <class Observer>
+void LIRSCacheT<Observer>::resize(int n) {
+    csize = n;
+    setLIRFraction(lir_fraction);
+    while (resident_map.size() > csize) {
+        size_t before = resident_map.size();
+        evict_HIR_block();
+        if (resident_map.size() == before) break;
     }
+    historyLimit = history_cap(compact ? csize : LLONG_MAX);
+    if (compact) nonresident.resize(historyLimit);
+    else if (nonresident_count > historyLimit) trim_history();
+}
 
-    // 3. Final Pruning: Remove x from the non-resident list if it was there (since it's now resident)
-    if (HIR_nonresident_list.front() == x) {
-        HIR_nonresident_list.pop_front();
+template <class Observer>
+void LIRSCacheT<Observer>::residents(std::vector<std::pair<long long int, bool> >& out) {
+    out.clear();
+    for (KeyList::iterator it = HIR_resident_list.begin(); it != HIR_resident_list.end(); it++) {
+        out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
+    }
+    for (KeyList::reverse_iterator it = R.rbegin(); it != R.rend(); it++) {
+        if (key_status_map.at(*it) != LIR) continue;
+        out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
     }
 }
 
+// ------------------------------------------------------------------
+// Snapshot: lir_size and its fraction, the R-Stack from top to bottom with each block's status,
+// then Q from front to back; dirty bits travel with the resident blocks. Compact mode
+// adds the clock, each resident's stamp and the non-resident filter
+// ------------------------------------------------------------------
+template <class Observer>
+bool LIRSCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "LIRS", csize);
+    snap_put(out, lir_size);
+    snap_put(out, lir_fraction);
+    snap_put(out, (uint8_t)compact);
+    snap_put(out, (long long int)R.size());
+    for (KeyList::iterator it = R.begin(); it != R.end(); it++) {
+        snap_put_entry(out, *it, accessType.count(*it) && accessType.at(*it) == "Write");
+        snap_put(out, (uint8_t)key_status_map.at(*it));
+        if (compact) snap_put(out, ref_time.at(*it));
+    }
+    snap_put(out, (long long int)HIR_resident_list.size());
+    for (KeyList::iterator it = HIR_resident_list.begin(); it != HIR_resident_list.end(); it++) {
+        snap_put_entry(out, *it, accessType.count(*it) && accessType.at(*it) == "Write");
+        if (compact) snap_put(out, ref_time.at(*it));
+    }
+    if (compact) {
+        snap_put(out, clock);
+        if (!nonresident.save(out)) return false;
+    }
+    return (bool)out;
+}
+
+template <class Observer>
+bool LIRSCacheT<Observer>::load(std::istream& in) {
+    long long int n = 0;
+    uint8_t fingerprints = 0;
+    if (!snap_check(in, "LIRS", csize) || !snap_get(in, lir_size) || !snap_get(in, lir_fraction) || !snap_get(in, fingerprints)) return false;
+    if ((bool)fingerprints != compact) {
+        std::cerr << "error: snapshot holds LIRS with " << (fingerprints ? "fingerprint" : "exact") << " non-resident history, cannot restore it into " << (compact ? "fingerprint" : "exact") << " history" << std::endl;
+        return false;
+    }
+    if (!snap_get(in, n)) return false;
+    R.clear();
+    R_map.clear();
+    resident_map.clear();
+    LIR_set.clear();
+    HIR_resident_list.clear();
+    Q_map.clear();
+    key_status_map.clear();
+    accessType.clear();
+    ref_time.clear();
+    nonresident_count = 0;
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        uint8_t status;
+        uint32_t stamp;
+        if (!snap_get_entry(in, x, dirty) || !snap_get(in, status)) return false;
+        if (compact) {
+            if (!snap_get(in, stamp)) return false;
+            ref_time[x] = stamp;
+        }
+        R.push_back(x);
+        R_map[x] = --R.end();
+        key_status_map[x] = (Status)status;
+        if (status == NON_RESIDENT_HIR) nonresident_count++;
+        if (status == LIR) {
+            LIR_set.insert(x);
+            resident_map[x] = true;
+            accessType[x] = dirty ? "Write" : "Read";
+        }
+    }
+    if (!snap_get(in, n)) return false;
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        uint32_t stamp;
+        if (!snap_get_entry(in, x, dirty)) return false;
+        if (compact) {
+            if (!snap_get(in, stamp)) return false;
+            ref_time[x] = stamp;
+        }
+        HIR_resident_list.push_back(x);
+        Q_map[x] = --HIR_resident_list.end();
+        key_status_map[x] = RESIDENT_HIR;
+        resident_map[x] = true;
+        accessType[x] = dirty ? "Write" : "Read";
+    }
+    if (compact && (!snap_get(in, clock) || !nonresident.load(in))) return false;
+    // a snapshot taken without the budget is trimmed to it
+    if (!compact && nonresident_count > historyLimit) trim_history();
+    return true;
+}
+
+// Batched references: the lookups of the whole batch are issued before the first update,
+// so their cache misses overlap instead of each one stalling the next; the updates then
+// run in order through refer(), so the result is that of referring the keys one by one.
+template <class Observer>
+void LIRSCacheT<Observer>::prefetch(const long long int* keys, int n) {
+    if (R_map.size() < PREFETCH_MIN_KEYS) return;
+    prefetch_buckets(key_status_map, keys, n, batch_buckets);
+    prefetch_buckets(R_map, keys, n, batch_buckets);
+    prefetch_buckets(resident_map, keys, n, batch_buckets);
+    prefetch_buckets(accessType, keys, n, batch_buckets);
+    for (int i = 0; i < n; i++) {
+        KeyMap<KeyList::iterator>::const_iterator it = R_map.find(keys[i]);
+        // the stack node is moved on a hit
+        if (it != R_map.end()) __builtin_prefetch(&*it->second, 1);
+    }
+}
+
+template <class Observer>
+int LIRSCacheT<Observer>::refer_batch(const long long int* keys, const string* ops, int n, char* hit, long long int* dirty) {
+    prefetch(keys, n);
+    int hitKeys = 0;
+    for (int i = 0; i < n; i++) {
+        long long int before = evictedDirtyPage;
+        bool h = refer(keys[i], ops[i]);
+        if (hit) hit[i] = h;
+        if (dirty) dirty[i] = evictedDirtyPage - before;
+        hitKeys += h;
+    }
+    return hitKeys;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int LIRSCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Stack pruning for earlier pages of the run can change the status of later
+    // ones, so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
 // ------------------------------------------------------------------
 // Remaining Required Methods
 // ------------------------------------------------------------------
-void LIRSCache::display() {
+template <class Observer>
+void LIRSCacheT<Observer>::display() {
 	std::cout << "LIRS Cache displayed." << std::endl;
 }
 
-void LIRSCache::cachehits() {
+template <class Observer>
+void LIRSCacheT<Observer>::cachehits() {
     float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
 
 	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "nonResident: " << ghost_size() << (compact ? " (fingerprints)" : "") << ", ghostBytes: " << ghost_bytes();
+	if (compact) std::cout << ", falseGhostHits: " << falseGhostHits;
+	std::cout << std::endl;
 
 	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
 	if (result.is_open()) { 
-		result <<  "LIRS " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << "\n" ;			
+		result <<  "LIRS " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " nonResident " << ghost_size() << " ghostBytes " << ghost_bytes();
+		if (compact) result << " falseGhostHits " << falseGhostHits;
+		result << "\n";
 	}
 	result.close();
+	report_budget("LIRS", ghost_size(), trimmed);
 }
 
-void LIRSCache::refresh(){
+template <class Observer>
+void LIRSCacheT<Observer>::refresh(){
 	calls = 0;
 	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	trimmed = 0;
+	falseGhostHits = 0;
 	migration = 0;
 }
 
-void LIRSCache::summary() {
+template <class Observer>
+void LIRSCacheT<Observer>::summary() {
 	// print the number of total cache calls, hits, and data migration size
-}
\ No newline at end of file
+}
+
+// The observers the simulator is built with (observer.h)
+template class LIRSCacheT<NullObserver>;
+template class LIRSCacheT<EventRecorder>;
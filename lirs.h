@@ -3,6 +3,13 @@
 #include <unordered_map>
 #include <list>
 #include <set> // To maintain the set of LIR pages (or LIR block keys)
+#include <vector>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "arena.h"
+#include "ghost.h"
+#include "budget.h"
 using namespace std; 
 #ifndef _lirs_H
 #define _lirs_H
@@ -10,55 +17,111 @@ using namespace std;
 // Forward declaration of the R-Stack Entry
 struct RStackEntry;
 
-class LIRSCache
+// Shared by every LIRSCacheT, whatever its observer
+struct LIRSDefaults
+{
+    static bool compactGhosts; // default for new caches (command line -g)
+};
+
+template <class Observer = NullObserver>
+class LIRSCacheT : private LIRSDefaults
 {
 private:
+    // backs the stacks, sets and maps below when -G is given (arena.h)
+    MetadataArena arena;
+
     int csize; // Maximum capacity of cache
     int lir_size; // Target size for LIR set (often based on a percentage of csize)
+    double lir_fraction; // lir_size as a share of csize, kept across resizes
     
     // R-Stack: Tracks recency. Implemented as a list of block keys.
-    std::list<long long int> R; 
+    KeyList R; 
     
     // Key-to-Entry Map: Maps a block key to its corresponding iterator in the R-Stack (R).
     // The long long int is the block key, the iterator is its position in R.
-    std::unordered_map<long long int, std::list<long long int>::iterator> R_map;
+    KeyMap<KeyList::iterator> R_map;
 
     // Cache Residency Check: Maps block key to a boolean indicating if it is CURRENTLY in the cache (LIR or resident HIR)
-    std::unordered_map<long long int, bool> resident_map;
+    KeyMap<bool> resident_map;
 
     // LIR Set: Uses a set for O(logN) lookup to check if a block is LIR.
-    std::set<long long int> LIR_set;
+    KeySet LIR_set;
 
-    // HIR Set (Non-resident): Tracks HIR keys that are NOT currently in the cache 
-    // but whose history we want to keep (similar to a ghost list).
-    std::list<long long int> HIR_nonresident_list;
+    // HIR Queue (Q): resident HIR blocks in reference order, the front is the next victim.
+    // Non-resident HIR blocks keep their history only while they are still in the R-Stack.
+    KeyList HIR_resident_list;
+    KeyMap<KeyList::iterator> Q_map;
 
     // Map to quickly check the status of a key (LIR, resident HIR, non-resident HIR)
     enum Status {NON_RESIDENT_HIR, RESIDENT_HIR, LIR};
-    std::unordered_map<long long int, Status> key_status_map;
+    KeyMap<Status> key_status_map;
+
+    // Compact mode: non-resident HIR blocks leave the R-Stack for a fingerprint filter,
+    // stamped with their last reference. Such a block is still "in the stack" while it
+    // was referenced after the bottom LIR block, so residents carry their stamp too.
+    bool compact;
+    GhostFilter nonresident;
+    KeyMap<uint32_t> ref_time;
+    uint32_t clock; // references seen, wraps around
+
+    // Non-resident HIR blocks remembered, and the cap on them: unbounded in the
+    // R-Stack unless a metadata budget is set, csize in the fingerprint filter
+    long long int nonresident_count;
+    long long int historyLimit;
+    long long int trimmed; // non-resident blocks dropped because of the budget
+    long long int falseGhostHits; // filter matches left by another key, taken for non-resident hits
 
     // Statistics (Similar to LRU/LFU)
-    std::unordered_map<long long int, string> accessType; 
+    KeyMap<string> accessType; 
     long long int calls, total_calls;
     long long int hits, total_hits;
     long long int readHits; 
     long long int writeHits; 
     long long int evictedDirtyPage; 
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
     long long int migration, total_migration;
 
     // Helper functions for the LIRS policy
+    std::vector<size_t> batch_buckets; // scratch space for prefetch: each key's bucket
+
     void prune_stack();
     void adjust_LIR_size();
     void evict_HIR_block();
-    void evict_LIR_block();
+    void trim_history();
+    long long int ghost_size();
+    long long int ghost_bytes();
     
 public:
-    LIRSCache(int);
-    ~LIRSCache();
-    void refer(long long int, string);
+    LIRSCacheT(int, bool verbose = true);
+    ~LIRSCacheT();
+    static void setCompactGhosts(bool); // fingerprint non-resident history for caches created afterwards
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    void prefetch(const long long int*, int); // brings the metadata of these keys into the CPU cache, changes nothing
+    int refer_batch(const long long int*, const string*, int, char* hit = NULL, long long int* dirty = NULL); // refer each key in order after prefetching them all, returns the hits; dirty: dirty victims per key
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    int getCapacity();
+    bool hasCompactGhosts();
+    long long int getGhostBytes();
+    long long int getFalseGhostHits();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts resident HIR blocks first
+    void setLIRFraction(double); // change the LIR set's share of the cache, surplus LIR blocks are demoted
+    double getLIRFraction();
+    void residents(std::vector<std::pair<long long int, bool> >&); // resident keys and dirty bits, Q first, then LIR blocks from the bottom of R
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
     void display();
     void cachehits();
     void refresh();
     void summary();
 };
-#endif
\ No newline at end of file
+
+typedef LIRSCacheT<> LIRSCache;
+#endif
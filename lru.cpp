@@ -19,7 +19,8 @@ This can be optimized by storing a reference
 #include <string.h>
 using namespace std; 
 
-LRUCache::LRUCache(int n) {
+template <class Observer>
+LRUCacheT<Observer>::LRUCacheT(int n, bool verbose) : dq(arena.list()), ma(arena.map<KeyList::iterator>()), accessType(arena.map<string>()) {
 	csize = n;
 	hits = 0;	// "hits" records the number of cache hit
 	total_hits = 0;
@@ -31,13 +32,18 @@ LRUCache::LRUCache(int n) {
 	readHits = 0; 
 	writeHits = 0; 
 	evictedDirtyPage = 0; 
+	sink = NULL;
+	page_size = PAGE_SIZE;
 	
-	std::cout << "LRU Algorithm is used" << std::endl;
-	std::cout << "Cache size is: " << csize <<  std::endl;
+	if (verbose) {
+		std::cout << "LRU Algorithm is used" << std::endl;
+		std::cout << "Cache size is: " << csize <<  std::endl;
+	}
 
 }
 
-LRUCache::~LRUCache() {
+template <class Observer>
+LRUCacheT<Observer>::~LRUCacheT() {
 	csize = 0;
 	hits = 0;	// "hits" records the number of cache hit
 	total_hits = 0;
@@ -55,36 +61,53 @@ LRUCache::~LRUCache() {
 	ma.clear();
 }
 
-void LRUCache::refer(long long int x, string rwtype) {
+// Evicts the key at the LRU end and hands it to the sink, returns the victim
+template <class Observer>
+long long int LRUCacheT<Observer>::evict_lru() {
+	// "last" is the key that is least used
+	long long int last = dq.back();
+	// evict the least used key from std::list<int> dp 
+	dq.pop_back();
+	// evict the least used key and its iterator from unordered_map<int, std::list<int>::iteratr> ma by key
+	ma.erase(last);
+
+	bool dirty = (accessType[last] == "Write");
+	if(dirty){
+		evictedDirtyPage++;
+	}
+	if (sink) sink->evicted(last, dirty);
+	observer.evict(last, dirty);
+	// the victim's access type goes with it, or the map grows with every key ever seen
+	accessType.erase(last);
+	return last;
+}
+
+template <class Observer>
+bool LRUCacheT<Observer>::refer(long long int x, string rwtype) {
 	calls++;
+	bool hit = false;
 	
 	//accessType[x] = rwtype; 
 	//total_calls++;
 	// if reference is not cached 
 	
 	if (ma.find(x) == ma.end()) {
+		observer.miss(x, rwtype);
 		// if cache is full
 		if (dq.size() == csize) {
-			// evict the least used key, "last" is the key that is least used
-			long long int last = dq.back();
-			// evict the least used key from std::list<int> dp 
-			dq.pop_back();
-			// evict the least used key and its iterator from unordered_map<int, std::list<int>::iteratr> ma by key
-			ma.erase(last);
-
-			if(accessType[last] == "Write"){
-				evictedDirtyPage++;				
-			}
-			
+			evict_lru();
 		}
 		// if reference is not cached, then it must be migrated into Optane cache
-		//migration++;
-		//total_migration++;
+		migration++;
+		total_migration++;
 		accessType[x] = rwtype; 
+		observer.insert(x);
 	}
 	// if reference is cached 
 	else {
 		hits++;
+		hit = true;
+		observer.hit(x, rwtype);
 		// evict the reference from dp by its corresponding iterator
 		dq.erase(ma[x]);
 		if(rwtype == "Read"){
@@ -99,18 +122,202 @@ void LRUCache::refer(long long int x, string rwtype) {
 	// update the cache table by inserting the new reference into the front of dp
 	dq.push_front(x);
 	ma[x] = dq.begin();
+	return hit;
+}
 
+template <class Observer>
+bool LRUCacheT<Observer>::contains(long long int x) {
+	return ma.find(x) != ma.end();
 }
 
-void LRUCache::display() {
+template <class Observer>
+bool LRUCacheT<Observer>::install(long long int x, string rwtype) {
+	if (contains(x)) return false;
+	// Installed like a miss, but it is not a demand reference
+	observer.installing(true);
+	refer(x, rwtype);
+	observer.installing(false);
+	calls--;
+	return true;
+}
+
+template <class Observer>
+long long int LRUCacheT<Observer>::getEvictedDirtyPage() {
+	return evictedDirtyPage;
+}
+
+template <class Observer>
+void LRUCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+	sink = s;
+}
+
+template <class Observer>
+void LRUCacheT<Observer>::setPageSize(int n) {
+	page_size = n;
+}
+
+template <class Observer>
+void LRUCacheT<Observer>::resize(int n) {
+	csize = n;
+	while (dq.size() > csize) {
+		evict_lru();
+	}
+}
+
+template <class Observer>
+void LRUCacheT<Observer>::residents(std::vector<std::pair<long long int, bool> >& out) {
+	out.clear();
+	for (KeyList::reverse_iterator it = dq.rbegin(); it != dq.rend(); it++) {
+		out.push_back(std::make_pair(*it, accessType.count(*it) && accessType.at(*it) == "Write"));
+	}
+}
+
+// Snapshot: the recency list from MRU to LRU, each key with its dirty bit
+template <class Observer>
+bool LRUCacheT<Observer>::save(std::ostream& out) {
+	snap_header(out, "LRU", csize);
+	snap_put(out, (long long int)dq.size());
+	for (KeyList::iterator it = dq.begin(); it != dq.end(); it++) {
+		snap_put_entry(out, *it, accessType[*it] == "Write");
+	}
+	return (bool)out;
+}
+
+template <class Observer>
+bool LRUCacheT<Observer>::load(std::istream& in) {
+	long long int n = 0;
+	if (!snap_check(in, "LRU", csize) || !snap_get(in, n)) return false;
+	dq.clear();
+	ma.clear();
+	accessType.clear();
+	ma.reserve(n);
+	for (long long int i = 0; i < n; i++) {
+		long long int x;
+		bool dirty;
+		if (!snap_get_entry(in, x, dirty)) return false;
+		dq.push_back(x);
+		ma[x] = --dq.end();
+		accessType[x] = dirty ? "Write" : "Read";
+	}
+	return true;
+}
+
+template <class Observer>
+int LRUCacheT<Observer>::size() {
+	return dq.size();
+}
+
+template <class Observer>
+long long int LRUCacheT<Observer>::lru() {
+	return dq.empty() ? -1 : dq.back();
+}
+
+template <class Observer>
+bool LRUCacheT<Observer>::remove(long long int x) {
+	KeyMap<KeyList::iterator>::iterator it = ma.find(x);
+	if (it == ma.end()) return false;
+	dq.erase(it->second);
+	ma.erase(it);
+	bool dirty = (accessType[x] == "Write");
+	accessType.erase(x);
+	return dirty;
+}
+
+// Batched references: the lookups of the whole batch are issued before the first update,
+// so their cache misses overlap instead of each one stalling the next; the updates then
+// run in order through refer(), so the result is that of referring the keys one by one.
+template <class Observer>
+void LRUCacheT<Observer>::prefetch(const long long int* keys, int n) {
+	if (ma.size() < PREFETCH_MIN_KEYS) return;
+	prefetch_buckets(ma, keys, n, batch_buckets);
+	prefetch_buckets(accessType, keys, n, batch_buckets);
+	for (int i = 0; i < n; i++) {
+		KeyMap<KeyList::iterator>::const_iterator it = ma.find(keys[i]);
+		// the list node is spliced to the front on a hit
+		if (it != ma.end()) __builtin_prefetch(&*it->second, 1);
+	}
+}
+
+template <class Observer>
+int LRUCacheT<Observer>::refer_batch(const long long int* keys, const string* ops, int n, char* hit, long long int* dirty) {
+	prefetch(keys, n);
+	int hitKeys = 0;
+	for (int i = 0; i < n; i++) {
+		long long int before = evictedDirtyPage;
+		bool h = refer(keys[i], ops[i]);
+		if (hit) hit[i] = h;
+		if (dirty) dirty[i] = evictedDirtyPage - before;
+		hitKeys += h;
+	}
+	return hitKeys;
+}
+
+// Range refer: handles every page touched by [offset, offset+length) in one call.
+// All hash lookups for the run are done up front, then the pages are applied in
+// address order, so the result is the same as referring each aligned page in turn.
+template <class Observer>
+int LRUCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+	if (length <= 0) return 0;
+	// align to whole pages so the same physical page always maps to the same key
+	long long int first = offset - offset % page_size;
+	int n = (int)((offset + length - 1) / page_size - offset / page_size + 1);
+
+	// batched lookups for the whole run
+	range_pos.resize(n);
+	range_hit.resize(n);
+	for (int i = 0; i < n; i++) {
+		KeyMap<KeyList::iterator>::iterator it = ma.find(first + (long long int)i * page_size);
+		range_hit[i] = (it != ma.end());
+		if (range_hit[i]) range_pos[i] = it->second;
+	}
+
+	int hitPages = 0;
+	for (int i = 0; i < n; i++) {
+		long long int x = first + (long long int)i * page_size;
+		calls++;
+		if (!range_hit[i]) {
+			observer.miss(x, rwtype);
+			if (dq.size() == csize) {
+				long long int last = evict_lru();
+				// a later page of this run may have been the victim
+				if (last > x && last < first + (long long int)n * page_size && (last - first) % page_size == 0) {
+					range_hit[(last - first) / page_size] = 0;
+				}
+			}
+			migration++;
+			total_migration++;
+			accessType[x] = rwtype;
+			dq.push_front(x);
+			ma[x] = dq.begin();
+			observer.insert(x);
+		} else {
+			hits++;
+			hitPages++;
+			observer.hit(x, rwtype);
+			// move to the front without reallocating the node, ma keeps the same iterator
+			dq.splice(dq.begin(), dq, range_pos[i]);
+			if(rwtype == "Read"){
+				readHits++;
+			} else {
+				writeHits++;
+				accessType[x] = "Write";
+			}
+		}
+	}
+	return hitPages;
+}
+
+template <class Observer>
+void LRUCacheT<Observer>::display() {
 	// print the cached key after program terminate 
-	for (std::list<long long int>::iterator xi = dq.begin(); xi != dq.end(); xi++) {
+	for (KeyList::iterator xi = dq.begin(); xi != dq.end(); xi++) {
 		std::cout << *xi << " ";
 	}
 	std::cout << std::endl;
 }
 
-void LRUCache::cachehits() {
+template <class Observer>
+void LRUCacheT<Observer>::cachehits() {
 	// print the number of total cache calls, hits, and data migration size
 	//std::cout << "LRU Algorithm Summary " << std::endl;
 	//std::cout << "the number of cache hits is: " << hits << std::endl;
@@ -127,18 +334,23 @@ void LRUCache::cachehits() {
 	result.close();
 }
 
-void LRUCache::refresh(){
-	//when a new query is start, reset the "calls", "hits", and "migration" to zero
+template <class Observer>
+void LRUCacheT<Observer>::refresh(){
+	//when a new query (or the measured phase after warmup) starts, reset every per-run counter to zero
 	calls = 0;
 	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
 	migration = 0;
 }
 
-void LRUCache::summary() {
+template <class Observer>
+void LRUCacheT<Observer>::summary() {
 	// print the number of total cache calls, hits, and data migration size
 	std::cout << "the total number of cache hits is: " << total_hits << std::endl;
 	std::cout << "the total number of total refered calls is " << total_calls << std::endl;
-	std::cout << "the total data migration size into the optane is: " << ((double)total_migration) * 16 / 1024/ 1024 << "GB" << std::endl;
+	std::cout << "the total data migration size into the optane is: " << ((double)total_migration) * page_size / 1024 / 1024 / 1024 << "GB" << std::endl;
 
 }
 
@@ -146,3 +358,7 @@ void LRUCache::summary() {
 complie the code in Ubuntu
 g++ -std=c++11 lru.cpp
 */
+
+// The observers the simulator is built with (observer.h)
+template class LRUCacheT<NullObserver>;
+template class LRUCacheT<EventRecorder>;
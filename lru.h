@@ -9,24 +9,35 @@ This can be optimized by storing a reference
 (iterator) to each key in a hash map. 
 */
 #include <string.h>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "arena.h"
 using namespace std; 
 #ifndef _lru_H
 #define _lru_H
 
-class LRUCache
+template <class Observer = NullObserver>
+class LRUCacheT
 {
+	// per-page metadata comes from here with -G (arena.h), so it is declared first
+	MetadataArena arena;
+
 	// store keys of cache 
-	std::list<long long int> dq;
+	KeyList dq;
 
 	// store references of key in cache
 	// note: using std::unordered_map to decrease average search time to O(1) 
 	// std::unordered_map is implemented as Hash Table
-	std::unordered_map<long long int, std::list<long long int>::iterator> ma;
+	KeyMap<KeyList::iterator> ma;
 	int csize; //maximum capacity of cache 
 
 
 	// record read-write type of cached page
-	std::unordered_map<long long int, string> accessType; 
+	KeyMap<string> accessType; 
 	
 
 
@@ -37,14 +48,42 @@ class LRUCache
 	long long int readHits; 
 	long long int writeHits; 
 	long long int evictedDirtyPage; 
+	EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+	Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+	int page_size; // keys are page-aligned byte addresses
+
+	// scratch space for refer_range: lookup results for each page of the run
+	std::vector<KeyList::iterator> range_pos;
+	std::vector<char> range_hit;
+	// scratch space for prefetch: each key's bucket
+	std::vector<size_t> batch_buckets;
 
 
 	long long int migration, total_migration;
 
+	long long int evict_lru();
+
 public:
-	LRUCache(int);
-	~LRUCache();
-	void refer(long long int, string);
+	LRUCacheT(int, bool verbose = true);
+	~LRUCacheT();
+	bool refer(long long int, string); // returns true on a cache hit
+	int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+	void prefetch(const long long int*, int); // brings the metadata of these keys into the CPU cache, changes nothing
+	int refer_batch(const long long int*, const string*, int, char* hit = NULL, long long int* dirty = NULL); // refer each key in order after prefetching them all, returns the hits; dirty: dirty victims per key
+	bool contains(long long int); // resident check, not counted as a reference
+	bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+	long long int getEvictedDirtyPage();
+	void setEvictionSink(EvictionSink*);
+
+	// segment helpers for policies built out of LRU lists (e.g. W-TinyLFU)
+	int size();
+	long long int lru(); // key at the LRU end, -1 when empty
+	bool remove(long long int); // drop a key without counting an eviction, returns true if it was dirty
+	void setPageSize(int);
+	void resize(int); // change the capacity, shrinking evicts from the LRU end
+	void residents(std::vector<std::pair<long long int, bool> >&); // resident keys and dirty bits, LRU first
+	bool save(std::ostream&); // write the full cache state as a binary snapshot
+	bool load(std::istream&); // restore a snapshot taken from the same policy and size
 	void display();
 
 	// summary results
@@ -54,4 +93,6 @@ public:
 	void summary();
 
 };
+
+typedef LRUCacheT<> LRUCache;
 #endif
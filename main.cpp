@@ -11,12 +11,33 @@
 #include "lirs.h"
 #include "arc.h"
 #include "cacheus.h"
-//#include "mq.h"
+#include "gdsf.h"
+#include "tinylfu.h"
+#include "latency.h"
+#include "writeback.h"
+#include "prefetch.h"
+#include "hierarchy.h"
+#include "opt.h"
+#include "partition.h"
+#include "tenant.h"
+#include "mq.h"
+#include "sieve.h"
+#include "s3fifo.h"
+#include "adaptive.h"
+#include "tuner.h"
+#include "trace.h"
+#include "budget.h"
+#include "arena.h"
+#include "regress.h"
 //#include "mru.h"
-//#include "lecar.h"
+#include "lecar.h"
 //#include "harc.h"
 //#include "exp.h"
 #include <math.h>
+#include <vector>
+#include <sstream>
+#include <thread>
+#include <chrono>
 #define CACHESIZE 1 // in GB
 static const char* pgmname;
 using namespace std; 
@@ -25,15 +46,936 @@ void usage()
 {
 	fprintf(stderr,
 		"Usage: %s -m <cache policy> -i <1:TCP/2:MSR> -f <filename>\n\n\
-		-m <cache policy>  LRU, MRU, LFU, MQ, ARC, LeCar, Exp ...\n\
+		-m <cache policy>  LRU, MRU, LFU, MQ, ARC, LeCaR, SIEVE, S3FIFO, Adaptive, Exp, GDS, GDSF, TinyLFU, OPT ...\n\
 		-f <TCP or MSR> 1: TPC 2: MSR traces\n\
 		-i <filename> \n\
 		-s <cacheSize> \n\
+		-w <N|Ts> warmup: replay the first N requests (or T seconds of trace time) without counting them\n\
+		-L <hit,read,write> device latency model in us per 4KB page (default 100,5000,5000)\n\
+		-B <high,low> coalescing write-back buffer watermarks in pages (default off)\n\
+		-p <pageSize> cache page size in bytes, request offsets are aligned to it (default 4096)\n\
+		-P <depth> sequential readahead depth in pages (default off)\n\
+		-b byte-capacity mode: each request is one object charged its size against cacheSize*4KB bytes\n\
+		-H <size0,size1,...> stack the policy into a cache hierarchy, tier sizes in pages from the top (replaces -s)\n\
+		-X exclusive hierarchy: a page lives in one tier only (default inclusive)\n\
+		-T <lat0,lat1,...> per-tier hit latency in us (default hit latency, x10 per tier below)\n\
+		-R <snapshot> restore the cache state from a snapshot before the replay (warm start)\n\
+		-S <snapshot> save the cache state to a snapshot after the replay\n\
+		-K <shards> split the trace by key hash into K partitions of cacheSize/K pages, replayed in parallel\n\
+		-k <batch> prefetch the LRU, LFU, LIRS, ARC or CACHEUS metadata of batch requests before serving them in order (default 1)\n\
+		-q <queues>[,lifeTime] MQ queue count (default 8) and block lifetime in references (default adaptive)\n\
+		-g fingerprint ghost lists for ARC and LIRS (16-bit tags, less memory, rare false ghost hits)\n\
+		-a auto-tune LIRS's LIR fraction or CACHEUS's write segment share with sampled mini-caches\n\
+		-M <entries> metadata budget: history entries (ghosts, non-resident keys) each cache may keep (default unbounded)\n\
+		-O <event log> record every hit, miss, insert, eviction, ghost hit and promotion of LRU, LFU, LIRS, ARC, CACHEUS, LeCaR, MQ, SIEVE or S3FIFO in a binary log\n\
+		-G <off|transparent|explicit> back LRU, LFU, LIRS, ARC and CACHEUS metadata with 4KB, transparent or explicit 2MB huge pages, and report it\n\
+		-V <golden>[,baseline[,percent]] regression check: every policy (or -m's) over the trace (default hm_1_short.csv) and synthetic ones, against golden results, and local throughput baselines if given (default 20%%)\n\
+		-W with -V: record the results into the golden file instead of checking them\n\
+		-t <shared|static|dynamic> multi-tenant mode: MSR device_disk tenants share the cache, get equal partitions, or utility-based ones\n\
 		", pgmname);
 	exit(1);
 }
 
 
+// Parse a comma separated list of numbers, e.g. "1000,10000"
+std::vector<double> parse_list(const char* arg)
+{
+	std::vector<double> values;
+	std::stringstream ss(arg);
+	string item;
+	while (getline(ss, item, ',')) {
+		values.push_back(atof(item.c_str()));
+	}
+	return values;
+}
+
+// Number of cache pages touched by a request
+int pages_of(long long int offset, int size, int pageSize)
+{
+	if (size <= 0) return 0;
+	return (int)((offset + size - 1) / pageSize - offset / pageSize + 1);
+}
+
+// Serve one request as a run of aligned pages, returns the number of pages that hit
+template <class Cache>
+int serve(Cache& ca, long long int offset, int size, int /*pageSize*/, string rwtype)
+{
+	return ca.refer_range(offset, size, rwtype);
+}
+
+// Size-aware policies charge the whole request as one object
+int serve(GDSFCache& ca, long long int offset, int size, int pageSize, string rwtype)
+{
+	return ca.refer(offset, size, rwtype) ? pages_of(offset, size, pageSize) : 0;
+}
+
+// Charge one served request to the latency model
+template <class Cache>
+void account(Cache& /*ca*/, LatencyModel* lat, int pages, int hitPages, bool write, long long int writeIOs, long long int writePages)
+{
+	lat->record(pages, hitPages, write, writeIOs, writePages);
+}
+
+// A hierarchy charges each hit page the latency of the tier that served it
+template <class Cache>
+void account(CacheHierarchy<Cache>& ca, LatencyModel* lat, int pages, int /*hitPages*/, bool write, long long int writeIOs, long long int writePages)
+{
+	lat->recordTiers(ca.getRequestTierHits(), pages, write, writeIOs, writePages);
+}
+
+// Everything the replay loop layers around the policy itself
+struct ReplayContext {
+	int trace_type;
+	int pageSize;
+	LatencyModel* lat;
+	WriteBackBuffer* wb; // NULL: dirty evictions are written straight to the device
+	Prefetcher* pf;      // NULL: no readahead
+	const char* restoreFrom; // NULL: start from an empty cache
+	const char* saveTo;      // NULL: no snapshot at the end
+	long long int warmupRequests; // requests replayed before the counters start
+	double warmupSeconds;         // trace time replayed before the counters start
+	int batch;                    // requests whose pages are prefetched together, 0 or 1 serves them one at a time
+	long long int readaheadWriteIOs;   // write-backs of the victims readahead displaced, charged to the next request
+	long long int readaheadWritePages;
+};
+
+// Prefetch the metadata of a batch of pages before they are referenced (-k); policies
+// without a prefetch path serve the batch as it is
+template <class Cache>
+void prefetch_pages(Cache& /*ca*/, const long long int* /*keys*/, int /*n*/)
+{
+}
+
+template <class Observer>
+void prefetch_pages(LRUCacheT<Observer>& ca, const long long int* keys, int n)
+{
+	ca.prefetch(keys, n);
+}
+
+template <class Observer>
+void prefetch_pages(LFUCacheT<Observer>& ca, const long long int* keys, int n)
+{
+	ca.prefetch(keys, n);
+}
+
+template <class Observer>
+void prefetch_pages(LIRSCacheT<Observer>& ca, const long long int* keys, int n)
+{
+	ca.prefetch(keys, n);
+}
+
+template <class Observer>
+void prefetch_pages(ARCCacheT<Observer>& ca, const long long int* keys, int n)
+{
+	ca.prefetch(keys, n);
+}
+
+template <class Observer>
+void prefetch_pages(CACHEUSCacheT<Observer>& ca, const long long int* keys, int n)
+{
+	ca.prefetch(keys, n);
+}
+
+// Refer a batch of pages in one call, the policy prefetching them all first (-k):
+// hit[i] is set if keys[i] hit, dirty[i] counts the dirty pages its reference evicted.
+// Returns false, having referred nothing, for policies without a batched path.
+template <class Cache>
+bool serve_batch(Cache& /*ca*/, const long long int* /*keys*/, const string* /*ops*/, int /*n*/, char* /*hit*/, long long int* /*dirty*/)
+{
+	return false;
+}
+
+template <class Observer>
+bool serve_batch(LRUCacheT<Observer>& ca, const long long int* keys, const string* ops, int n, char* hit, long long int* dirty)
+{
+	ca.refer_batch(keys, ops, n, hit, dirty);
+	return true;
+}
+
+template <class Observer>
+bool serve_batch(LFUCacheT<Observer>& ca, const long long int* keys, const string* ops, int n, char* hit, long long int* dirty)
+{
+	ca.refer_batch(keys, ops, n, hit, dirty);
+	return true;
+}
+
+template <class Observer>
+bool serve_batch(LIRSCacheT<Observer>& ca, const long long int* keys, const string* ops, int n, char* hit, long long int* dirty)
+{
+	ca.refer_batch(keys, ops, n, hit, dirty);
+	return true;
+}
+
+template <class Observer>
+bool serve_batch(ARCCacheT<Observer>& ca, const long long int* keys, const string* ops, int n, char* hit, long long int* dirty)
+{
+	ca.refer_batch(keys, ops, n, hit, dirty);
+	return true;
+}
+
+template <class Observer>
+bool serve_batch(CACHEUSCacheT<Observer>& ca, const long long int* keys, const string* ops, int n, char* hit, long long int* dirty)
+{
+	ca.refer_batch(keys, ops, n, hit, dirty);
+	return true;
+}
+
+// Serve one request and account for it: latency model, write-back I/Os and readahead;
+// returns the number of pages that hit
+template <class Cache>
+int request(Cache& ca, long long int offset, int size, string rwtype, ReplayContext& rc)
+{
+	int pages = pages_of(offset, size, rc.pageSize);
+	if (rc.pf) {
+		// settle outstanding prefetches before the demand reference makes them resident
+		long long int first = offset - offset % rc.pageSize;
+		for (int i = 0; i < pages; i++) {
+			long long int page = first + (long long int)i * rc.pageSize;
+			rc.pf->demand(page, ca.contains(page));
+		}
+	}
+
+	// without a buffer every dirty victim is a write I/O of its own
+	long long int writesBefore = rc.wb ? rc.wb->getFlushIOs() : ca.getEvictedDirtyPage();
+	long long int writtenBefore = rc.wb ? rc.wb->getFlushedPages() : writesBefore;
+	int hitPages = serve(ca, offset, size, rc.pageSize, rwtype);
+	long long int writesAfter = rc.wb ? rc.wb->getFlushIOs() : ca.getEvictedDirtyPage();
+	long long int writtenAfter = rc.wb ? rc.wb->getFlushedPages() : writesAfter;
+	// the device is still busy with the write-backs the previous readahead caused
+	account(ca, rc.lat, pages, hitPages, rwtype == "Write", writesAfter - writesBefore + rc.readaheadWriteIOs, writtenAfter - writtenBefore + rc.readaheadWritePages);
+	rc.readaheadWriteIOs = 0;
+	rc.readaheadWritePages = 0;
+
+	if (rc.pf && rwtype == "Read") {
+		// readahead follows read streams and is issued in the background, after the request completes
+		const std::vector<long long int>& predicted = rc.pf->access(offset, pages, hitPages);
+		for (size_t i = 0; i < predicted.size(); i++) {
+			if (ca.install(predicted[i], "Read")) rc.pf->installed(predicted[i]);
+		}
+		if (metadata_budget() > 0) rc.pf->settle(ca);
+		// a readahead page that displaced a dirty one is not free: its write-back delays the next request
+		rc.readaheadWriteIOs = (rc.wb ? rc.wb->getFlushIOs() : ca.getEvictedDirtyPage()) - writesAfter;
+		rc.readaheadWritePages = (rc.wb ? rc.wb->getFlushedPages() : ca.getEvictedDirtyPage()) - writtenAfter;
+	}
+	return hitPages;
+}
+
+// Read the trace and hand every request to next(time, offset, size, rwtype, tenant), time in seconds
+template <class Handler>
+int scan(char* filename, int trace_type, int pageSize, Handler& next)
+{
+	static const string read = "Read";
+	static const string write = "Write";
+	string tenant = "tpch"; // MSR rows name their volume, TPC-H traces are one tenant
+
+	TraceReader trace;
+	if (!trace.open(filename)) {
+	std::cerr << "error: unable to open input file" << std::endl;
+		return -1;
+	}
+
+	if(trace_type == 2){  // for MSR traces
+		MSRRecord r;
+		string device;
+		int disk = -1;
+		while (trace.nextMSR(r)) {
+			//request unit: 0.5KB, cached in aligned pages of pageSize bytes
+			if (r.disk != disk || device.compare(0, string::npos, r.host, r.hostLength) != 0) {
+				// consecutive rows mostly come from one volume, the name is rebuilt on a change
+				device.assign(r.host, r.hostLength);
+				disk = r.disk;
+				tenant = device + "_" + std::to_string(disk);
+			}
+			next(r.timestamp / 1e7, r.offset, r.size, r.write ? write : read, tenant); // MSR timestamps are 100ns ticks
+		}
+	}else{    // for TPC-H traces
+		KeyRecord r;
+		while (trace.nextKey(r)) {
+			// each key is one page; a W access pattern is a write, anything else a read
+			next(r.time, r.key * pageSize, pageSize, (r.pattern == 'W' || r.pattern == 'w') ? write : read, tenant);
+		}
+	}
+	if (trace.getSkipped() > 0) {
+		std::cerr << "warning: skipped " << trace.getSkipped() << " lines of " << filename << " that are not trace records" << std::endl;
+	}
+	return 0;
+}
+
+// Warmup is over: everything counted so far is discarded, the cache state is kept
+template <class Cache>
+void warmed(Cache& ca, ReplayContext& rc, long long int requests)
+{
+	ca.refresh();
+	rc.lat->refresh();
+	rc.readaheadWriteIOs = 0;
+	rc.readaheadWritePages = 0;
+	if (rc.wb) rc.wb->refresh();
+	if (rc.pf) rc.pf->refresh();
+	// one write, so lines from concurrently replayed partitions do not interleave
+	std::ostringstream line;
+	line << "Warmup done after " << requests << " requests, counting from here\n";
+	std::cout << line.str() << std::flush;
+}
+
+// Serves each scanned request from the cache, once the warmup has been replayed
+template <class Cache>
+struct Requester {
+	Cache& ca;
+	ReplayContext& rc;
+	bool warming;
+	long long int seen;
+	double start;
+	// pages counted since the warmup, for merging partitions that replay separately
+	long long int pages;
+	long long int hitPages;
+	long long int readHits;
+	long long int writeHits;
+	// requests held back until a batch is complete, the pages they touch and how each page was served
+	std::vector<TraceRequest> pending;
+	std::vector<long long int> keys;
+	std::vector<string> ops;
+	std::vector<char> hit;
+	std::vector<long long int> dirty;
+	void operator()(double time, long long int offset, int size, string rwtype, const string& /*tenant*/) {
+		if (rc.batch > 1) {
+			TraceRequest r = {time, offset, size, rwtype};
+			pending.push_back(r);
+			if ((int)pending.size() >= rc.batch) flush();
+			return;
+		}
+		serve_request(time, offset, size, rwtype);
+	}
+	// Serve the held back requests in order, after prefetching every page they touch
+	void flush() {
+		if (pending.empty()) return;
+		keys.clear();
+		ops.clear();
+		for (size_t i = 0; i < pending.size(); i++) {
+			long long int first = pending[i].offset - pending[i].offset % rc.pageSize;
+			int pages = pages_of(pending[i].offset, pending[i].size, rc.pageSize);
+			for (int p = 0; p < pages; p++) {
+				keys.push_back(first + (long long int)p * rc.pageSize);
+				ops.push_back(pending[i].rwtype);
+			}
+		}
+		// requests of zero bytes touch no page
+		if (keys.empty()) {
+			for (size_t i = 0; i < pending.size(); i++) {
+				serve_request(pending[i].time, pending[i].offset, pending[i].size, pending[i].rwtype);
+			}
+			pending.clear();
+			return;
+		}
+
+		// the policy refers the whole batch when nothing has to run between its requests:
+		// no warmup ending, no readahead, no write-back buffer
+		hit.resize(keys.size());
+		dirty.resize(keys.size());
+		if (!warming && !rc.pf && !rc.wb && serve_batch(ca, &keys[0], &ops[0], (int)keys.size(), &hit[0], &dirty[0])) {
+			size_t k = 0;
+			for (size_t i = 0; i < pending.size(); i++) {
+				int pages = pages_of(pending[i].offset, pending[i].size, rc.pageSize);
+				int hitPages = 0;
+				long long int writes = 0;
+				for (int p = 0; p < pages; p++, k++) {
+					hitPages += hit[k];
+					writes += dirty[k];
+				}
+				seen++;
+				// every dirty victim is a write I/O of its own
+				account(ca, rc.lat, pages, hitPages, pending[i].rwtype == "Write", writes, writes);
+				tally(pages, hitPages, pending[i].rwtype);
+			}
+			pending.clear();
+			return;
+		}
+
+		prefetch_pages(ca, &keys[0], (int)keys.size());
+		for (size_t i = 0; i < pending.size(); i++) {
+			serve_request(pending[i].time, pending[i].offset, pending[i].size, pending[i].rwtype);
+		}
+		pending.clear();
+	}
+	void serve_request(double time, long long int offset, int size, const string& rwtype) {
+		if (warming) {
+			if (seen == 0) start = time;
+			if (seen >= rc.warmupRequests && time - start >= rc.warmupSeconds) {
+				warmed(ca, rc, seen);
+				warming = false;
+				pages = hitPages = readHits = writeHits = 0;
+			}
+		}
+		seen++;
+		tally(pages_of(offset, size, rc.pageSize), request(ca, offset, size, rwtype, rc), rwtype);
+	}
+	void tally(int requestPages, int requestHits, const string& rwtype) {
+		pages += requestPages;
+		hitPages += requestHits;
+		if (rwtype == "Read") readHits += requestHits;
+		else writeHits += requestHits;
+	}
+};
+
+// -g: what fingerprint ghost lists cost in hits against the bytes they save. Only ARC
+// and LIRS keep them; the generic overload has nothing to compare
+template <class Cache>
+void audit_ghosts(Cache& /*ca*/, char* /*filename*/, ReplayContext& /*rc*/, const string& /*cache_policy*/, long long int /*pages*/, long long int /*hitPages*/)
+{
+}
+
+// Replays the trace once more through the policy with exact ghost lists, quietly and
+// with a latency model of its own, and sets its hit ratio and ghost bytes beside the
+// fingerprint run's
+template <class Exact, class Cache>
+void compare_ghosts(Cache& ca, char* filename, ReplayContext& rc, const string& cache_policy, long long int pages, long long int hitPages)
+{
+	if (!ca.hasCompactGhosts()) return;
+	// readahead and a restored snapshot make the second replay differ from the first
+	if (rc.pf || rc.restoreFrom) {
+		std::cout << "fingerprint ghosts: no exact comparison with readahead or a restored snapshot" << std::endl;
+		return;
+	}
+	std::streambuf* out = std::cout.rdbuf(NULL);
+	Exact::setCompactGhosts(false);
+	Exact exact(ca.getCapacity(), false);
+	Exact::setCompactGhosts(true);
+	exact.setPageSize(rc.pageSize);
+	LatencyModel lat(*rc.lat);
+	ReplayContext twin = rc;
+	twin.lat = &lat;
+	twin.wb = NULL; // the write-back buffer changes no hit
+	twin.saveTo = NULL;
+	Requester<Exact> next = {exact, twin, rc.warmupRequests > 0 || rc.warmupSeconds > 0, 0, 0, 0, 0, 0, 0, std::vector<TraceRequest>(), std::vector<long long int>(), std::vector<string>(), std::vector<char>(), std::vector<long long int>()};
+	int scanned = scan(filename, twin.trace_type, twin.pageSize, next);
+	next.flush();
+	std::cout.rdbuf(out);
+	std::cout.clear();
+	if (scanned < 0) return;
+
+	double hitRatio = (pages > 0) ? (double)hitPages / pages : 0.0;
+	double exactHitRatio = (next.pages > 0) ? (double)next.hitPages / next.pages : 0.0;
+	long long int bytes = ca.getGhostBytes();
+	long long int exactBytes = exact.getGhostBytes();
+	std::cout << "fingerprint ghosts: hitRatio " << hitRatio << " against " << exactHitRatio << " with exact ones (delta " << hitRatio - exactHitRatio << "), ghostBytes " << bytes << " against " << exactBytes << " (saved " << exactBytes - bytes << "), falseGhostHits " << ca.getFalseGhostHits() << std::endl;
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result << cache_policy << " fingerprintGhosts hitRatio " << hitRatio << " exactHitRatio " << exactHitRatio << " hitRatioDelta " << hitRatio - exactHitRatio << " ghostBytes " << bytes << " exactGhostBytes " << exactBytes << " savedBytes " << exactBytes - bytes << " falseGhostHits " << ca.getFalseGhostHits() << "\n";
+	}
+}
+
+template <class Observer>
+void audit_ghosts(ARCCacheT<Observer>& ca, char* filename, ReplayContext& rc, const string& cache_policy, long long int pages, long long int hitPages)
+{
+	compare_ghosts<ARCCache>(ca, filename, rc, cache_policy, pages, hitPages);
+}
+
+template <class Observer>
+void audit_ghosts(LIRSCacheT<Observer>& ca, char* filename, ReplayContext& rc, const string& cache_policy, long long int pages, long long int hitPages)
+{
+	compare_ghosts<LIRSCache>(ca, filename, rc, cache_policy, pages, hitPages);
+}
+
+// Replay the trace through one cache policy, applying the latency model to every request
+template <class Cache>
+int replay(Cache& ca, char* filename, ReplayContext& rc, string cache_policy)
+{
+	// dirty victims are destaged through the write-back buffer when one is configured
+	ca.setEvictionSink(rc.wb);
+	ca.setPageSize(rc.pageSize);
+
+	if (rc.restoreFrom) {
+		// warm start: the replay continues from a saved cache state
+		std::ifstream snapshot(rc.restoreFrom, std::ios::binary);
+		if (!snapshot.is_open() || !ca.load(snapshot)) {
+			std::cerr << "error: unable to restore snapshot " << rc.restoreFrom << std::endl;
+			return -1;
+		}
+		std::cout << "Restored cache state from " << rc.restoreFrom << std::endl;
+	}
+
+	Requester<Cache> next = {ca, rc, rc.warmupRequests > 0 || rc.warmupSeconds > 0, 0, 0, 0, 0, 0, 0, std::vector<TraceRequest>(), std::vector<long long int>(), std::vector<string>(), std::vector<char>(), std::vector<long long int>()};
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	if (scan(filename, rc.trace_type, rc.pageSize, next) < 0) {
+		return -1;
+	}
+	next.flush();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	if (next.warming) {
+		std::cerr << "warning: the trace ended during warmup, the results include it" << std::endl;
+	}
+
+	// print cache hit and estimated response time
+
+	ca.cachehits();
+	audit_ghosts(ca, filename, rc, cache_policy, next.pages, next.hitPages);
+	arena_report(cache_policy, next.seen, elapsed);
+	rc.lat->report(cache_policy);
+	if (rc.wb) {
+		rc.wb->drain();
+		rc.wb->report(cache_policy);
+	}
+	if (rc.pf) {
+		rc.pf->finish(ca);
+		rc.pf->report(cache_policy);
+	}
+	if (rc.saveTo) {
+		std::ofstream snapshot(rc.saveTo, std::ios::binary);
+		if (!snapshot.is_open() || !ca.save(snapshot)) {
+			std::cerr << "error: unable to save snapshot " << rc.saveTo << std::endl;
+			return -1;
+		}
+		std::cout << "Saved cache state to " << rc.saveTo << std::endl;
+	}
+	std::cout << std::endl;
+	return 0;
+}
+
+// Replays one partition's requests as the parser hands them over
+template <class Cache>
+void replay_shard(Requester<Cache>* next, RequestQueue* queue)
+{
+	std::vector<TraceRequest> batch;
+	while (queue->pop(batch)) {
+		for (size_t i = 0; i < batch.size(); i++) {
+			(*next)(batch[i].time, batch[i].offset, batch[i].size, batch[i].rwtype, "");
+		}
+	}
+	next->flush();
+}
+
+// Replay the trace as K key-hash partitions, each through its own cache of csize/K pages
+// with its own latency model and write-back buffer, one thread per partition. Every
+// page maps to exactly one partition, so the result is that of K independent caches
+// (a sharded cache), and the partitions' statistics are merged at the end.
+template <class Cache>
+int replay_partitioned(int csize, int shards, char* filename, ReplayContext& rc, string cache_policy)
+{
+	std::vector<Cache*> caches;
+	std::vector<LatencyModel*> lats;
+	std::vector<WriteBackBuffer*> wbs;
+	std::vector<ReplayContext> contexts(shards, rc); // sized once, the requesters keep references
+	std::vector<Requester<Cache>*> next;
+	for (int i = 0; i < shards; i++) {
+		int size = csize / shards + (i < csize % shards ? 1 : 0);
+		std::cout << "Shard " << i << ": ";
+		caches.push_back(new Cache(size));
+		lats.push_back(new LatencyModel(*rc.lat));
+		// each partition destages through a buffer of its own
+		wbs.push_back(rc.wb ? new WriteBackBuffer(*rc.wb) : NULL);
+		contexts[i].lat = lats[i];
+		contexts[i].wb = wbs[i];
+		contexts[i].warmupRequests = rc.warmupRequests / shards;
+		caches[i]->setEvictionSink(wbs[i]);
+		caches[i]->setPageSize(rc.pageSize);
+		Requester<Cache> r = {*caches[i], contexts[i], rc.warmupRequests > 0 || rc.warmupSeconds > 0, 0, 0, 0, 0, 0, 0, std::vector<TraceRequest>(), std::vector<long long int>(), std::vector<string>(), std::vector<char>(), std::vector<long long int>()};
+		next.push_back(new Requester<Cache>(r));
+	}
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+	std::vector<RequestQueue> queues(shards);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < shards; i++) {
+		workers.push_back(std::thread(replay_shard<Cache>, next[i], &queues[i]));
+	}
+	// the trace is read once; the parser partitions it while the shards replay
+	Partitioner partitioner(shards, rc.pageSize, queues);
+	int ret = scan(filename, rc.trace_type, rc.pageSize, partitioner);
+	partitioner.finish();
+	for (int i = 0; i < shards; i++) workers[i].join();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	if (ret == 0) {
+		long long int calls = 0, hits = 0, readHits = 0, writeHits = 0, evictedDirtyPage = 0, requests = 0;
+		float minRatio = 1.0, maxRatio = 0.0;
+		bool warming = false;
+		for (int i = 0; i < shards; i++) {
+			calls += next[i]->pages;
+			requests += next[i]->seen;
+			hits += next[i]->hitPages;
+			readHits += next[i]->readHits;
+			writeHits += next[i]->writeHits;
+			evictedDirtyPage += caches[i]->getEvictedDirtyPage();
+			float ratio = (next[i]->pages > 0) ? (float)next[i]->hitPages / next[i]->pages : 0.0;
+			minRatio = min(minRatio, ratio);
+			maxRatio = max(maxRatio, ratio);
+			if (next[i]->warming) warming = true;
+			rc.lat->merge(*lats[i]);
+			if (rc.wb) {
+				wbs[i]->drain();
+				rc.wb->merge(*wbs[i]);
+			}
+		}
+		if (warming) {
+			std::cerr << "warning: the trace ended during warmup of a partition, the results include it" << std::endl;
+		}
+		float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+		// print merged cache hit and estimated response time
+		std::cout << "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " << writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+		partitioner.report();
+		std::cout << "shard hitRatio min: " << minRatio << ", max: " << maxRatio << ", replayTime(s): " << elapsed << std::endl;
+		arena_report(cache_policy, requests, elapsed);
+
+		std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+		if (result.is_open()) {
+			result << cache_policy << " Partitioned shards " << shards << " CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " writeHits " << writeHits << " evictedDirtyPage " << evictedDirtyPage << " minShardHitRatio " << minRatio << " maxShardHitRatio " << maxRatio << "\n";
+		}
+		result.close();
+		rc.lat->report(cache_policy);
+		if (rc.wb) rc.wb->report(cache_policy);
+		std::cout << std::endl;
+	}
+
+	for (int i = 0; i < shards; i++) {
+		delete next[i];
+		delete caches[i];
+		delete lats[i];
+		delete wbs[i];
+	}
+	return ret;
+}
+
+// Cache pages of tenant t when the cache is split into units, as exact shares of csize
+int share_of(int csize, const std::vector<int>& units, int t)
+{
+	long long int total = 0, before = 0;
+	for (size_t i = 0; i < units.size(); i++) {
+		total += units[i];
+		if ((int)i < t) before += units[i];
+	}
+	long long int pages = csize * (before + units[t]) / total - csize * before / total;
+	return max(1, (int)pages);
+}
+
+// Serves each scanned request from its tenant's partition (or the shared cache) and
+// keeps per-tenant hit counts and latency; in dynamic mode the partitions are resized
+// from the tenants' utility monitors every time a cache's worth of pages has been referenced
+template <class Cache>
+struct TenantRequester {
+	TenantDirectory& tenants;
+	std::vector<Cache*>& caches;            // one per tenant, or the one shared cache
+	std::vector<LatencyModel*>& lats;       // one per tenant
+	std::vector<UtilityMonitor*>& monitors; // dynamic partitioning only
+	std::vector<int>& units;                // current allocation, in TENANT_UNITS
+	ReplayContext& rc;
+	int csize;
+	bool warming;
+	long long int seen;
+	double start;
+	long long int epochPages; // pages referenced since the last repartitioning
+	long long int repartitions;
+	std::vector<long long int> pages;
+	std::vector<long long int> hitPages;
+
+	void operator()(double time, long long int offset, int size, string rwtype, const string& tenant) {
+		if (warming) {
+			if (seen == 0) start = time;
+			if (seen >= rc.warmupRequests && time - start >= rc.warmupSeconds) {
+				for (size_t i = 0; i < caches.size(); i++) caches[i]->refresh();
+				for (size_t i = 0; i < lats.size(); i++) lats[i]->refresh();
+				if (rc.wb) rc.wb->refresh();
+				std::cout << "Warmup done after " << seen << " requests, counting from here" << std::endl;
+				pages.assign(pages.size(), 0);
+				hitPages.assign(hitPages.size(), 0);
+				warming = false;
+			}
+		}
+		seen++;
+
+		int t = tenants.id(tenant);
+		Cache& ca = *caches[caches.size() == 1 ? 0 : t];
+		ReplayContext ctx = rc;
+		ctx.lat = lats[t];
+		int n = pages_of(offset, size, rc.pageSize);
+		pages[t] += n;
+		hitPages[t] += request(ca, offset, size, rwtype, ctx);
+
+		if (!monitors.empty()) {
+			long long int first = offset - offset % rc.pageSize;
+			for (int i = 0; i < n; i++) monitors[t]->access(first + (long long int)i * rc.pageSize);
+			epochPages += n;
+			if (epochPages >= csize) {
+				units = lookahead_partition(monitors, TENANT_UNITS);
+				for (size_t i = 0; i < caches.size(); i++) {
+					caches[i]->resize(share_of(csize, units, (int)i));
+					monitors[i]->age();
+				}
+				epochPages = 0;
+				repartitions++;
+			}
+		}
+	}
+};
+
+// Replay a trace of several tenants (MSR device_disk volumes) through one shared cache,
+// equal static partitions, or utility-based dynamic partitions, and report each tenant
+template <class Cache>
+int replay_tenants(int csize, TenantMode mode, char* filename, ReplayContext& rc, string cache_policy)
+{
+	// a first pass over the trace finds the tenants
+	TenantDirectory tenants;
+	if (scan(filename, rc.trace_type, rc.pageSize, tenants) < 0) {
+		return -1;
+	}
+	int n = tenants.size();
+	if (n == 0 || n > csize || (mode == TENANT_DYNAMIC && n > TENANT_UNITS)) {
+		std::cerr << "error: " << n << " tenants cannot be given a partition each of a cache of " << csize << " pages" << std::endl;
+		return -1;
+	}
+	const char* modeName = (mode == TENANT_SHARED) ? "shared" : (mode == TENANT_STATIC) ? "static" : "dynamic";
+	std::cout << n << " tenants, " << modeName << " cache" << std::endl;
+
+	std::vector<Cache*> caches;
+	std::vector<LatencyModel*> lats;
+	std::vector<UtilityMonitor*> monitors;
+	// static and dynamic partitions start as equal shares
+	std::vector<int> units(n, 1);
+	for (int t = 0; t < n; t++) {
+		lats.push_back(new LatencyModel(*rc.lat));
+		if (mode == TENANT_DYNAMIC) monitors.push_back(new UtilityMonitor(csize));
+		if (mode == TENANT_SHARED) continue;
+		std::cout << "Tenant " << tenants.name(t) << ": ";
+		caches.push_back(new Cache(share_of(csize, units, t)));
+	}
+	if (mode == TENANT_SHARED) caches.push_back(new Cache(csize));
+	for (size_t i = 0; i < caches.size(); i++) {
+		caches[i]->setEvictionSink(rc.wb);
+		caches[i]->setPageSize(rc.pageSize);
+	}
+
+	TenantRequester<Cache> next = {tenants, caches, lats, monitors, units, rc, csize, rc.warmupRequests > 0 || rc.warmupSeconds > 0, 0, 0, 0, 0, std::vector<long long int>(n, 0), std::vector<long long int>(n, 0)};
+	int ret = scan(filename, rc.trace_type, rc.pageSize, next);
+	if (ret == 0) {
+		if (next.warming) {
+			std::cerr << "warning: the trace ended during warmup, the results include it" << std::endl;
+		}
+		long long int calls = 0, hits = 0, evictedDirtyPage = 0;
+		for (size_t i = 0; i < caches.size(); i++) evictedDirtyPage += caches[i]->getEvictedDirtyPage();
+
+		// print each tenant's cache hit and estimated response time, then the totals
+		std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+		for (int t = 0; t < n; t++) {
+			int size = (mode == TENANT_SHARED) ? csize : share_of(csize, units, t);
+			float hitRatio = (next.pages[t] > 0) ? (float)next.hitPages[t] / next.pages[t] : 0.0;
+			calls += next.pages[t];
+			hits += next.hitPages[t];
+			std::cout << "tenant " << tenants.name(t) << ": cacheSize: " << size << ", calls: " << next.pages[t] << ", hits: " << next.hitPages[t] << ", hitRatio: " << hitRatio << std::endl;
+			if (result.is_open()) {
+				result << cache_policy << " Tenant " << tenants.name(t) << " mode " << modeName << " CacheSize " << size << " calls " << next.pages[t] << " hits " << next.hitPages[t] << " hitRatio " << hitRatio << "\n";
+			}
+			lats[t]->report(cache_policy + " " + tenants.name(t));
+			rc.lat->merge(*lats[t]);
+		}
+		float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+		std::cout << "calls: " << calls << ", hits: " << hits << ", hitRatio: " << hitRatio << ", evictedDirtyPage: " << evictedDirtyPage;
+		if (mode == TENANT_DYNAMIC) std::cout << ", repartitions: " << next.repartitions;
+		std::cout << std::endl;
+		if (result.is_open()) {
+			result << cache_policy << " Tenants " << n << " mode " << modeName << " CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " evictedDirtyPage " << evictedDirtyPage << " repartitions " << next.repartitions << "\n";
+		}
+		result.close();
+		rc.lat->report(cache_policy);
+		if (rc.wb) {
+			rc.wb->drain();
+			rc.wb->report(cache_policy);
+		}
+		std::cout << std::endl;
+	}
+
+	for (size_t i = 0; i < caches.size(); i++) delete caches[i];
+	for (int t = 0; t < n; t++) delete lats[t];
+	for (size_t i = 0; i < monitors.size(); i++) delete monitors[i];
+	return ret;
+}
+
+// Offline pre-pass for OPT: records every page reference of the trace
+struct Recorder {
+	OPTCache& ca;
+	void operator()(double /*time*/, long long int offset, int size, string /*rwtype*/, const string& /*tenant*/) {
+		ca.record(offset, size);
+	}
+};
+
+// Replay with one cache of csize pages, K partitions of it, per-tenant partitions, or with a hierarchy of tierSizes built from the same policy
+template <class Cache>
+int simulate(int csize, const std::vector<int>& tierSizes, bool exclusive, int shards, const char* tenantMode, char* filename, ReplayContext& rc, string cache_policy)
+{
+	if (tenantMode) {
+		TenantMode mode = (strcmp(tenantMode, "shared") == 0) ? TENANT_SHARED : (strcmp(tenantMode, "static") == 0) ? TENANT_STATIC : TENANT_DYNAMIC;
+		return replay_tenants<Cache>(csize, mode, filename, rc, cache_policy);
+	}
+	if (shards > 1) {
+		return replay_partitioned<Cache>(csize, shards, filename, rc, cache_policy);
+	}
+	if (tierSizes.empty()) {
+		Cache ca(csize);
+		return replay(ca, filename, rc, cache_policy);
+	}
+	CacheHierarchy<Cache> ca(tierSizes, exclusive, cache_policy);
+	return replay(ca, filename, rc, cache_policy);
+}
+
+// The same for a policy built with an observer (observer.h): its events go to the event log with -O, otherwise the hooks compile away
+template <template <class> class Policy>
+int simulate_observed(bool observed, int csize, const std::vector<int>& tierSizes, bool exclusive, int shards, const char* tenantMode, char* filename, ReplayContext& rc, string cache_policy)
+{
+	if (observed) {
+		return simulate<Policy<EventRecorder> >(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	return simulate<Policy<NullObserver> >(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+}
+
+// Collects the requests of a trace, so a regression run times the replay and not the parser
+struct Collector {
+	std::vector<TraceRequest>& requests;
+	void operator()(double time, long long int offset, int size, string rwtype, const string& /*tenant*/) {
+		TraceRequest r = {time, offset, size, rwtype};
+		requests.push_back(r);
+	}
+};
+
+// A fresh cache for one regression run; the size-aware and offline policies are built differently
+template <class Cache>
+Cache* regress_cache(int csize, int /*pageSize*/, const string& /*policy*/, const std::vector<TraceRequest>& /*trace*/)
+{
+	return new Cache(csize);
+}
+
+template <>
+GDSFCache* regress_cache<GDSFCache>(int csize, int pageSize, const string& policy, const std::vector<TraceRequest>& /*trace*/)
+{
+	return new GDSFCache((long long int)csize * pageSize, policy);
+}
+
+template <>
+OPTCache* regress_cache<OPTCache>(int csize, int pageSize, const string& /*policy*/, const std::vector<TraceRequest>& trace)
+{
+	OPTCache* ca = new OPTCache(csize);
+	ca->setPageSize(pageSize);
+	for (size_t i = 0; i < trace.size(); i++) ca->record(trace[i].offset, trace[i].size);
+	ca->prepare();
+	return ca;
+}
+
+// Replay an in-memory trace once through a fresh cache; elapsed is the processor time
+// of the replay itself, so other load on the machine does not pass for a regression
+template <class Cache>
+RegressResult regress_once(const string& traceName, const std::vector<TraceRequest>& trace, int csize, int pageSize, const string& policy, double& elapsed)
+{
+	// policies announce themselves when built; the check prints one line per run instead
+	std::streambuf* out = std::cout.rdbuf(NULL);
+	Cache* ca = regress_cache<Cache>(csize, pageSize, policy, trace);
+	ca->setPageSize(pageSize);
+	LatencyModel lat(100, 5000, 5000);
+	ReplayContext rc = {2, pageSize, &lat, NULL, NULL, NULL, NULL, 0, 0, 1, 0, 0};
+	RegressResult r = {traceName, policy, csize, 0, 0, 0, 0, 0, 0, 0};
+
+	std::clock_t begin = std::clock();
+	for (size_t i = 0; i < trace.size(); i++) {
+		const TraceRequest& q = trace[i];
+		int pages = pages_of(q.offset, q.size, pageSize);
+		int hit = request(*ca, q.offset, q.size, q.rwtype, rc);
+		r.calls += pages;
+		r.hits += hit;
+		if (q.rwtype == "Read") r.readHits += hit;
+		else r.writeHits += hit;
+		if (pages > 0) r.hitBytes += (long long int)q.size * hit / pages;
+	}
+	elapsed = (double)(std::clock() - begin) / CLOCKS_PER_SEC;
+	r.evictedDirtyPage = ca->getEvictedDirtyPage();
+	delete ca;
+	std::cout.rdbuf(out);
+	std::cout.clear();
+	return r;
+}
+
+bool same_counts(const RegressResult& a, const RegressResult& b)
+{
+	return a.calls == b.calls && a.hits == b.hits && a.readHits == b.readHits && a.writeHits == b.writeHits
+	    && a.evictedDirtyPage == b.evictedDirtyPage && a.hitBytes == b.hitBytes;
+}
+
+// Replay a trace twice through fresh caches, their counts must agree. With a throughput
+// baseline, each of REGRESS_REPEATS measurements then replays it until REGRESS_MIN_SECONDS
+// of processor time have passed (a single replay of the short traces takes milliseconds),
+// and the fastest measurement gives the throughput
+template <class Cache>
+void regress(RegressionCheck& check, const string& traceName, const std::vector<TraceRequest>& trace, int csize, int pageSize, const string& policy)
+{
+	double elapsed;
+	RegressResult result = regress_once<Cache>(traceName, trace, csize, pageSize, policy, elapsed);
+	bool stable = same_counts(regress_once<Cache>(traceName, trace, csize, pageSize, policy, elapsed), result);
+	for (int rep = 0; stable && check.timed() && rep < REGRESS_REPEATS; rep++) {
+		double seconds = 0;
+		long long int requests = 0;
+		while (stable && seconds < REGRESS_MIN_SECONDS) {
+			stable = same_counts(regress_once<Cache>(traceName, trace, csize, pageSize, policy, elapsed), result);
+			seconds += elapsed;
+			requests += trace.size();
+		}
+		if (seconds > 0) result.throughput = max(result.throughput, requests / seconds);
+	}
+	check.check(result, stable);
+}
+
+// A run of the suite is selected by -m with its name or the name of its base policy (ARC selects ARC-g)
+bool wanted(const string& only, const string& name)
+{
+	return only.empty() || name == only || name.compare(0, only.size() + 1, only + "-") == 0;
+}
+
+// -V: every policy over the given trace and the synthetic ones, at their default settings
+int regress_suite(const string& golden, const string& baseline, double threshold, bool record, const string& only, const char* filename, int trace_type, int csize, int pageSize)
+{
+	RegressionCheck check(golden, baseline, threshold, record);
+	if (!check.load()) return 1;
+
+	// the recorded trace first, parsed once up front
+	std::vector<string> names;
+	std::vector<std::vector<TraceRequest> > traces(1 + synthetic_traces().size());
+	const char* path = filename ? filename : "hm_1_short.csv";
+	string base = path;
+	names.push_back(base.substr(base.find_last_of('/') + 1));
+	Collector collector = {traces[0]};
+	if (scan((char*)path, filename ? trace_type : 2, pageSize, collector) < 0) return 1;
+	for (size_t t = 0; t < synthetic_traces().size(); t++) {
+		names.push_back(synthetic_traces()[t]);
+		synthetic_trace(names.back(), csize, pageSize, traces[t + 1]);
+	}
+
+	// the golden results are those of the default knobs, whatever else the command line set
+	MQCache::setDefaults(MQ_QUEUES, 0);
+	metadata_budget() = 0;
+	for (size_t t = 0; t < traces.size(); t++) {
+		const std::vector<TraceRequest>& trace = traces[t];
+		if (wanted(only, "LRU")) regress<LRUCache>(check, names[t], trace, csize, pageSize, "LRU");
+		if (wanted(only, "LFU")) regress<LFUCache>(check, names[t], trace, csize, pageSize, "LFU");
+		if (wanted(only, "LIRS")) regress<LIRSCache>(check, names[t], trace, csize, pageSize, "LIRS");
+		if (wanted(only, "ARC")) regress<ARCCache>(check, names[t], trace, csize, pageSize, "ARC");
+		if (wanted(only, "CACHEUS")) regress<CACHEUSCache>(check, names[t], trace, csize, pageSize, "CACHEUS");
+		if (wanted(only, "TinyLFU")) regress<WTinyLFUCache>(check, names[t], trace, csize, pageSize, "TinyLFU");
+		if (wanted(only, "LeCaR")) regress<LeCaRCache>(check, names[t], trace, csize, pageSize, "LeCaR");
+		if (wanted(only, "MQ")) regress<MQCache>(check, names[t], trace, csize, pageSize, "MQ");
+		if (wanted(only, "SIEVE")) regress<SIEVECache>(check, names[t], trace, csize, pageSize, "SIEVE");
+		if (wanted(only, "S3FIFO")) regress<S3FIFOCache>(check, names[t], trace, csize, pageSize, "S3FIFO");
+		if (wanted(only, "Adaptive")) regress<AdaptiveCache>(check, names[t], trace, csize, pageSize, "Adaptive");
+		if (wanted(only, "OPT")) regress<OPTCache>(check, names[t], trace, csize, pageSize, "OPT");
+		if (wanted(only, "GDS")) regress<GDSFCache>(check, names[t], trace, csize, pageSize, "GDS");
+		if (wanted(only, "GDSF")) regress<GDSFCache>(check, names[t], trace, csize, pageSize, "GDSF");
+		// the fingerprint ghosts and the tuners are separate code paths
+		ARCCache::setCompactGhosts(true);
+		LIRSCache::setCompactGhosts(true);
+		if (wanted(only, "ARC-g")) regress<ARCCache>(check, names[t], trace, csize, pageSize, "ARC-g");
+		if (wanted(only, "LIRS-g")) regress<LIRSCache>(check, names[t], trace, csize, pageSize, "LIRS-g");
+		ARCCache::setCompactGhosts(false);
+		LIRSCache::setCompactGhosts(false);
+		if (wanted(only, "LIRS-a")) regress<TunedCache<LIRSCache> >(check, names[t], trace, csize, pageSize, "LIRS-a");
+		if (wanted(only, "CACHEUS-a")) regress<TunedCache<CACHEUSCache> >(check, names[t], trace, csize, pageSize, "CACHEUS-a");
+	}
+	return check.finish();
+}
+
+
 int main(int argc, char* argv[])
 {
 
@@ -46,26 +988,55 @@ int main(int argc, char* argv[])
 	srand((unsigned int)time(NULL));
 
 
-	// read timestamp
-	double timestamp2;
-	// read key (or offset or address)
-	long long int key;
 	int j = 0;
 	pgmname = argv[j++];
 	string cache_policy;
 	int trace_type = 0;
-	char AccessPattern;
-	char* filename;
+	char* filename = NULL;
 	std::string operation = "Write";
 
-	long long int timestamp;
-	string device;
-	int disk;
-	string rwtype;
-	long long int offset;
-	int size;
+	int csize = 0;
+	int pageSize = 4 * 1024;
 
-	int csize;
+	// device latency model, in microseconds per 4KB page
+	double hitLatency = 100;
+	double readLatency = 5000;
+	double writeLatency = 5000;
+
+	// write-back buffer watermarks in pages, 0 disables the buffer
+	int wbHigh = 0;
+	int wbLow = 0;
+	// readahead depth in pages, 0 disables prefetching
+	int pfDepth = 0;
+	// cache hierarchy: tier sizes in pages and hit latencies in us, top tier first
+	std::vector<int> tierSizes;
+	std::vector<double> tierLatency;
+	bool exclusive = false;
+	// cache state snapshots, restored before and saved after the replay
+	const char* restoreFrom = NULL;
+	const char* saveTo = NULL;
+	// warmup, in requests or in seconds of trace time; 0 counts from the first request
+	long long int warmupRequests = 0;
+	double warmupSeconds = 0;
+	// key-hash partitions replayed in parallel, 1 replays the trace as one stream
+	int shards = 1;
+	// multi-tenant mode: shared, static or dynamic; NULL replays the trace as one tenant
+	const char* tenantMode = NULL;
+	// MQ: number of LRU queues and block lifetime in references, 0 adapts the lifetime
+	int mqQueues = MQ_QUEUES;
+	int mqLifeTime = 0;
+	// LIRS and CACHEUS: tune the LIR fraction or the segment split while replaying
+	bool autoTune = false;
+	// regression check against a golden file, and throughput regressions against a local
+	// baseline file flagged beyond a percentage; the golden file is only written with -W
+	string regressGolden;
+	string regressBaseline;
+	double regressThreshold = REGRESS_THRESHOLD;
+	bool regressRecord = false;
+	// requests whose pages are prefetched together before they are served, 1 serves them one at a time
+	int batch = 1;
+	// binary log of the policy's events, NULL records none
+	const char* eventLog = NULL;
 
 	bool LRU = false;
 	bool MRU = false; 
@@ -77,15 +1048,17 @@ int main(int argc, char* argv[])
 	bool HARC = false;
 	bool Exp = false;
 	bool CACHEUS = false;
+	bool GDS = false;
+	bool GDSF = false;
+	bool TinyLFU = false;
+	bool OPT = false;
+	bool SIEVE = false;
+	bool S3FIFO = false;
+	bool Adaptive = false;
+	// byte-capacity mode: requests are variable-sized objects instead of 4KB pages
+	bool byteMode = false;
 
 
-	string temp1;
-	string temp2;
-	string temp3;
-	string temp4;
-	string temp5;
-	string temp6;
-	string temp7;
 	// open input file
 	if(j >= argc)
 	{
@@ -112,6 +1085,13 @@ int main(int argc, char* argv[])
 		    else if(cache_policy == "LeCaR") LeCaR = true;//LeCaRCache ca(CACHESIZE*1024*1024*2);
 		    else if(cache_policy == "HARC") HARC = true;//LeCaRCache ca(CACHESIZE*1024*1024*2);
 		    else if(cache_policy == "Exp") Exp = true;//ExpCache ca(CACHESIZE*1024*1024*2);
+		    else if(cache_policy == "GDS") GDS = true;
+		    else if(cache_policy == "GDSF") GDSF = true;
+		    else if(cache_policy == "TinyLFU") TinyLFU = true;
+		    else if(cache_policy == "OPT") OPT = true;
+		    else if(cache_policy == "SIEVE") SIEVE = true;
+		    else if(cache_policy == "S3FIFO") S3FIFO = true;
+		    else if(cache_policy == "Adaptive") Adaptive = true;
 		    else{
 			fprintf(stderr, "Wrong cache type\n");
 			usage();
@@ -133,7 +1113,7 @@ int main(int argc, char* argv[])
 			{
 			    if(++ j >= argc)
 			    {
-				fprintf(stderr, "supply number of warmup IOs to -w\n");
+				fprintf(stderr, "missing input file name\n");
 				usage();
 			    }
 			    filename = argv[j++];
@@ -146,7 +1126,209 @@ int main(int argc, char* argv[])
 				    usage();
 				}
 				csize = atoi(argv[j++]);
-				break;
+
+			} else if (strcmp(argv[j], "-w") == 0) {
+
+				char* unit = NULL;
+				double warmup = (++ j < argc) ? strtod(argv[j], &unit) : -1;
+				if(warmup < 0 || (*unit != '\0' && strcmp(unit, "s") != 0))
+				{
+				    fprintf(stderr, "supply number of warmup IOs to -w, or a time in seconds as <T>s\n");
+				    usage();
+				}
+				if (*unit == 's') warmupSeconds = warmup;
+				else warmupRequests = (long long int)warmup;
+				j++;
+
+			} else if (strcmp(argv[j], "-L") == 0) {
+
+				if(++ j >= argc || sscanf(argv[j], "%lf,%lf,%lf", &hitLatency, &readLatency, &writeLatency) != 3)
+				{
+				    fprintf(stderr, "latency model is <hit,read,write> in us\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-B") == 0) {
+
+				if(++ j >= argc || sscanf(argv[j], "%d,%d", &wbHigh, &wbLow) != 2)
+				{
+				    fprintf(stderr, "write-back buffer is <high,low> watermark in pages\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-p") == 0) {
+
+				if(++ j >= argc || (pageSize = atoi(argv[j])) <= 0)
+				{
+				    fprintf(stderr, "page size must be a positive number of bytes\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-P") == 0) {
+
+				if(++ j >= argc || (pfDepth = atoi(argv[j])) <= 0)
+				{
+				    fprintf(stderr, "readahead depth must be a positive number of pages\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-b") == 0) {
+
+				byteMode = true;
+				j++;
+
+			} else if (strcmp(argv[j], "-H") == 0) {
+
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "hierarchy is <size0,size1,...> tier sizes in pages\n");
+				    usage();
+				}
+				std::vector<double> sizes = parse_list(argv[j++]);
+				tierSizes.clear();
+				for (size_t t = 0; t < sizes.size(); t++) tierSizes.push_back((int)sizes[t]);
+				if (tierSizes.size() < 2)
+				{
+				    fprintf(stderr, "a hierarchy needs at least two tiers\n");
+				    usage();
+				}
+				for (size_t t = 0; t < tierSizes.size(); t++) {
+				    if (tierSizes[t] <= 0)
+				    {
+					fprintf(stderr, "every tier holds at least one page\n");
+					usage();
+				    }
+				}
+
+			} else if (strcmp(argv[j], "-X") == 0) {
+
+				exclusive = true;
+				j++;
+
+			} else if (strcmp(argv[j], "-g") == 0) {
+
+				// ARC and LIRS keep their ghost history as 16-bit fingerprints
+				ARCCache::setCompactGhosts(true);
+				LIRSCache::setCompactGhosts(true);
+				j++;
+
+			} else if (strcmp(argv[j], "-V") == 0) {
+
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "regression check is <golden file>[,baseline file[,percent]]\n");
+				    usage();
+				}
+				const char* comma = strchr(argv[j], ',');
+				regressGolden.assign(argv[j], comma ? comma - argv[j] : strlen(argv[j]));
+				if (comma) {
+					const char* second = strchr(comma + 1, ',');
+					regressBaseline.assign(comma + 1, second ? second - comma - 1 : strlen(comma + 1));
+					if (regressBaseline.empty() || (second && (regressThreshold = atof(second + 1)) <= 0))
+					{
+					    fprintf(stderr, "throughput check is a baseline file and a positive percentage\n");
+					    usage();
+					}
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-W") == 0) {
+
+				regressRecord = true;
+				j++;
+
+			} else if (strcmp(argv[j], "-O") == 0) {
+
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "missing event log file name\n");
+				    usage();
+				}
+				eventLog = argv[j++];
+
+			} else if (strcmp(argv[j], "-G") == 0) {
+
+				if(++ j >= argc || (strcmp(argv[j], "off") != 0 && strcmp(argv[j], "transparent") != 0 && strcmp(argv[j], "explicit") != 0))
+				{
+				    fprintf(stderr, "huge pages are off, transparent or explicit\n");
+				    usage();
+				}
+				arena_set_huge_pages(strcmp(argv[j], "off") == 0 ? HUGE_PAGES_OFF : strcmp(argv[j], "transparent") == 0 ? HUGE_PAGES_TRANSPARENT : HUGE_PAGES_EXPLICIT);
+				j++;
+
+			} else if (strcmp(argv[j], "-M") == 0) {
+
+				if(++ j >= argc || (metadata_budget() = atoll(argv[j])) <= 0)
+				{
+				    fprintf(stderr, "metadata budget must be a positive number of history entries\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-a") == 0) {
+
+				autoTune = true;
+				j++;
+
+			} else if (strcmp(argv[j], "-T") == 0) {
+
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "tier latencies are <lat0,lat1,...> in us\n");
+				    usage();
+				}
+				tierLatency = parse_list(argv[j++]);
+
+			} else if (strcmp(argv[j], "-R") == 0 || strcmp(argv[j], "-S") == 0) {
+
+				bool restore = (strcmp(argv[j], "-R") == 0);
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "missing snapshot file name\n");
+				    usage();
+				}
+				if (restore) restoreFrom = argv[j++];
+				else saveTo = argv[j++];
+
+			} else if (strcmp(argv[j], "-K") == 0) {
+
+				if(++ j >= argc || (shards = atoi(argv[j])) <= 0)
+				{
+				    fprintf(stderr, "number of partitions must be a positive number\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-k") == 0) {
+
+				if(++ j >= argc || (batch = atoi(argv[j])) <= 0)
+				{
+				    fprintf(stderr, "batch must be a positive number of requests\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-q") == 0) {
+
+				if(++ j >= argc || sscanf(argv[j], "%d,%d", &mqQueues, &mqLifeTime) < 1 || mqQueues <= 0 || mqLifeTime < 0)
+				{
+				    fprintf(stderr, "MQ is <queues>[,lifeTime] with lifeTime in references\n");
+				    usage();
+				}
+				j++;
+
+			} else if (strcmp(argv[j], "-t") == 0) {
+
+				if(++ j >= argc || (strcmp(argv[j], "shared") != 0 && strcmp(argv[j], "static") != 0 && strcmp(argv[j], "dynamic") != 0))
+				{
+				    fprintf(stderr, "tenant mode is shared, static or dynamic\n");
+				    usage();
+				}
+				tenantMode = argv[j++];
 
 			} else{
 			    fprintf(stderr, "missing option\n");
@@ -158,6 +1340,44 @@ int main(int argc, char* argv[])
 	}
 
 
+	if (regressRecord && regressGolden.empty()) {
+		std::cerr << "-W records the results of a regression check, it needs -V" << std::endl;
+		return 1;
+	}
+	if (!regressGolden.empty()) {
+		return regress_suite(regressGolden, regressBaseline, regressThreshold, regressRecord, cache_policy, filename, trace_type, csize > 0 ? csize : REGRESS_CACHE_SIZE, pageSize);
+	}
+
+	if (!filename) {
+		fprintf(stderr, "missing input file name\n");
+		usage();
+	}
+	if (tierSizes.empty() && csize <= 0) {
+		// no policy can evict from an empty cache
+		fprintf(stderr, "cache size is at least one page, -s is missing or not positive\n");
+		usage();
+	}
+
+	if (!tierSizes.empty()) {
+		// the hierarchy's capacity is the sum of its tiers
+		csize = 0;
+		for (size_t t = 0; t < tierSizes.size(); t++) csize += tierSizes[t];
+	}
+
+	bool observed = (eventLog != NULL);
+	if (observed && (GDS || GDSF || byteMode || TinyLFU || OPT || Adaptive || MRU || HARC || Exp || autoTune || shards > 1)) {
+		std::cerr << "the event log records LRU, LFU, LIRS, ARC, CACHEUS, LeCaR, MQ, SIEVE and S3FIFO, it cannot be combined with byte-capacity mode, auto-tuning or partitioned replay" << std::endl;
+		return 1;
+	}
+	if (batch > 1 && (!(LRU || LFU || LIRS || ARC || CACHEUS) || byteMode || autoTune || !tierSizes.empty())) {
+		std::cerr << "batched replay prefetches the metadata of LRU, LFU, LIRS, ARC and CACHEUS, it cannot be combined with byte-capacity mode, auto-tuning or a hierarchy" << std::endl;
+		return 1;
+	}
+	if (observed && !EventLog::get().open(eventLog)) {
+		std::cerr << "error: unable to write the event log " << eventLog << std::endl;
+		return 1;
+	}
+
 	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
 	if (result.is_open()) { 
 		result <<  filename << " ";			
@@ -165,74 +1385,131 @@ int main(int argc, char* argv[])
 	result.close();
 
 
-	std::ifstream myfile(filename);
-	// check the open is succeeded
 	std::cout <<"File: "<< filename<< " "<<"Policy: "<<cache_policy<< "  " <<"Cache size: "<< csize <<std::endl;
-	int count = 0;
-	//LRU example
-	if(LIRS){
-
-
-		LIRSCache ca(csize);
-		if (myfile.is_open()) {
-			while(!myfile.eof())
-			{
-			    
-				if(trace_type == 2){  // for MSR traces                
-					getline(myfile,temp1,','); //timestamp
-					getline(myfile,temp2,',');  //device
-					getline(myfile,temp3,',');  //disk
-					getline(myfile,temp4,','); //read or write
-					getline(myfile,temp5,',');  //offset   
-					getline(myfile,temp6,',');  //request size
-					getline(myfile,temp7);  //temp
-					if (!temp1.empty()){
-					   
-					    timestamp = std::stoll(temp1);
-					    
-					    device = temp2;
-					    disk = std::stoi(temp3);
-					    rwtype = temp4;
-					    offset = std::stoll(temp5);;
-					    size = std::stoi(temp6);
-					    //temp7 = std::stoi(temp7);
-					    
-					    //request unit: 0.5KB 
-					    for(int i = 0; i< (int)ceil(size/(4.0*1024)); i ++){
-						ca.refer(offset + i*1024*4, rwtype); 
-					    }
-					    //std::cout << timestamp<< " "<< device<<" "<< disk<<" "<< rwtype<<" " <<offset<<" " <<size<<" " <<temp7<< std::endl;
-					    //std::cout << count<< " " << temp1<< " "<< temp2<<" "<< temp3<<" "<< temp4<<" "<<temp5<<" "<<temp6<<" "<<temp7<< std::endl;
-					    count = count + 1; 
-					    
-					    
-					}
-			       
-			    	}else{    // for TPC-H traces
-					while (myfile >> timestamp2 >> key >> AccessPattern) {
-					    ca.refer(key, rwtype);
-				}
-			    }
+	LatencyModel lat(hitLatency, readLatency, writeLatency);
+	if (!tierSizes.empty()) {
+		// unspecified tiers are ten times slower than the one above
+		if (tierLatency.empty()) tierLatency.push_back(hitLatency);
+		while (tierLatency.size() < tierSizes.size()) tierLatency.push_back(tierLatency.back() * 10);
+		lat.setTierLatency(tierLatency);
+	}
+	WriteBackBuffer* wb = NULL;
+	if (wbHigh > 0) wb = new WriteBackBuffer(wbHigh, wbLow, pageSize);
+	Prefetcher* pf = NULL;
+	if (pfDepth > 0) pf = new Prefetcher(pfDepth, pageSize);
 
-			}
-		}else{
-		std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+	ReplayContext rc;
+	rc.trace_type = trace_type;
+	rc.pageSize = pageSize;
+	rc.lat = &lat;
+	rc.wb = wb;
+	rc.pf = pf;
+	rc.restoreFrom = restoreFrom;
+	rc.saveTo = saveTo;
+	rc.warmupRequests = warmupRequests;
+	rc.warmupSeconds = warmupSeconds;
+	rc.batch = batch;
+	rc.readaheadWriteIOs = 0;
+	rc.readaheadWritePages = 0;
+	// run the selected policy over the trace
+	int ret = 0;
+	if(tenantMode && (GDS || GDSF || byteMode || OPT || pf || !tierSizes.empty() || shards > 1 || batch > 1 || restoreFrom || saveTo)){
+		std::cerr << "multi-tenant mode runs single page caches, it cannot be combined with byte-capacity mode, OPT, readahead, a hierarchy, partitioned replay, batched replay or snapshots" << std::endl;
+		ret = 1;
+	}
+	else if(shards > 1 && (GDS || GDSF || byteMode || OPT || pf || !tierSizes.empty() || restoreFrom || saveTo)){
+		std::cerr << "partitioned replay runs single page caches, it cannot be combined with byte-capacity mode, OPT, readahead, a hierarchy or snapshots" << std::endl;
+		ret = 1;
+	}
+	else if(shards > 1 && shards > csize){
+		std::cerr << "every partition needs at least one page of cache" << std::endl;
+		ret = 1;
+	}
+	else if((GDS || GDSF || byteMode) && pf){
+		std::cerr << "readahead works on pages, it cannot be combined with byte-capacity mode" << std::endl;
+		ret = 1;
+	}
+	else if((GDS || GDSF || byteMode) && !tierSizes.empty()){
+		std::cerr << "a cache hierarchy is built from page policies, it cannot be combined with byte-capacity mode" << std::endl;
+		ret = 1;
+	}
+	else if(GDS || GDSF || (byteMode && (LRU || LFU))){
+		// size-aware variants, capacity is cacheSize pages worth of bytes
+		GDSFCache ca((long long int)csize * pageSize, cache_policy);
+		ret = replay(ca, filename, rc, cache_policy);
+	}
+	else if(byteMode){
+		std::cerr << "no size-aware variant of " << cache_policy << std::endl;
+		ret = 1;
+	}
+	else if(autoTune && !LIRS && !CACHEUS){
+		std::cerr << "auto-tuning applies to LIRS and CACHEUS" << std::endl;
+		ret = 1;
+	}
+	else if(OPT && (pf || !tierSizes.empty())){
+		std::cerr << "OPT only knows the recorded demand references, it cannot be combined with readahead or a hierarchy" << std::endl;
+		ret = 1;
+	}
+	else if(OPT){
+		// offline: a first pass over the trace tells OPT every future reference
+		OPTCache ca(csize);
+		ca.setPageSize(pageSize);
+		Recorder recorder = {ca};
+		ret = scan(filename, trace_type, pageSize, recorder);
+		if (ret == 0) {
+			ca.prepare();
+			ret = replay(ca, filename, rc, cache_policy);
 		}
-
-
-		// print cache hit
-
-		ca.cachehits();
-		std::cout << std::endl;
-		// close the input file 
-		myfile.close();
+	}
+	else if(LRU){
+		ret = simulate_observed<LRUCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(LFU){
+		ret = simulate_observed<LFUCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(LIRS && autoTune){
+		ret = simulate<TunedCache<LIRSCache> >(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(LIRS){
+		ret = simulate_observed<LIRSCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(ARC){
+		ret = simulate_observed<ARCCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(CACHEUS && autoTune){
+		ret = simulate<TunedCache<CACHEUSCache> >(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(CACHEUS){
+		ret = simulate_observed<CACHEUSCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(TinyLFU){
+		ret = simulate<WTinyLFUCache>(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(LeCaR){
+		ret = simulate_observed<LeCaRCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(MQ){
+		MQCache::setDefaults(mqQueues, mqLifeTime);
+		ret = simulate_observed<MQCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(SIEVE){
+		ret = simulate_observed<SIEVECacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(S3FIFO){
+		ret = simulate_observed<S3FIFOCacheT>(observed, csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
+	}
+	else if(Adaptive){
+		ret = simulate<AdaptiveCache>(csize, tierSizes, exclusive, shards, tenantMode, filename, rc, cache_policy);
 	}
 	else{
 
 		std::cerr << "cannot find a proper cache policy" << std::endl;
+		ret = 1;
 	}
+	delete wb;
+	delete pf;
+	EventLog::get().close();
 
 
-	return 0;
+	return ret;
 }
@@ -0,0 +1,396 @@
+/* mq.cpp - MQ (Multi-Queue) Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "mq.h"
+using namespace std;
+
+int MQDefaults::defaultQueues = MQ_QUEUES;
+int MQDefaults::defaultLifeTime = 0;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+template <class Observer>
+MQCacheT<Observer>::MQCacheT(int n) : MQCacheT(n, defaultQueues, defaultLifeTime) {
+}
+
+// With lifeTime 0 the lifetime starts at C references and then follows the
+// peak temporal distance of the workload, as suggested by Zhou et al.
+template <class Observer>
+MQCacheT<Observer>::MQCacheT(int n, int m, int life) {
+    csize = n;
+    queues = max(1, m);
+    adaptive = (life <= 0);
+    lifeTime = adaptive ? max(1, csize) : life;
+    Q.resize(queues);
+    distances.assign(MQ_DISTANCE_CLASSES, 0);
+    sinceTune = 0;
+    time = 0;
+    historyLimit = history_cap((long long int)MQ_HISTORY_FACTOR * csize);
+    trimmed = 0;
+
+    // Initialize statistics variables
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    demotions = 0;
+    migration = 0;
+    total_migration = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "MQ Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << ", Queues: " << queues << ", LifeTime: " << lifeTime << (adaptive ? " (adaptive)" : "") << ", History: " << MQ_HISTORY_FACTOR * csize << std::endl;
+}
+
+template <class Observer>
+MQCacheT<Observer>::~MQCacheT() {
+    Q.clear();
+    blocks.clear();
+    Qout.clear();
+    history.clear();
+}
+
+template <class Observer>
+void MQCacheT<Observer>::setDefaults(int m, int life) {
+    defaultQueues = m;
+    defaultLifeTime = life;
+}
+
+// ------------------------------------------------------------------
+// MQ Helper Functions
+// ------------------------------------------------------------------
+template <class Observer>
+int MQCacheT<Observer>::queue_of(int freq) {
+    // floor(log2(freq)) from the leading zero count, O(1)
+    int k = 31 - __builtin_clz((unsigned int)max(1, freq));
+    return min(k, queues - 1);
+}
+
+template <class Observer>
+void MQCacheT<Observer>::insert(long long int x, int freq, long long int last, bool dirty) {
+    int k = queue_of(freq);
+    Q[k].push_front(x);
+    Block b = {Q[k].begin(), k, freq, time, last, dirty};
+    blocks[x] = b;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::trim_history() {
+    while ((long long int)Qout.size() > historyLimit) {
+        if ((long long int)Qout.size() <= (long long int)MQ_HISTORY_FACTOR * csize) trimmed++;
+        history.erase(Qout.back());
+        Qout.pop_back();
+    }
+}
+
+template <class Observer>
+void MQCacheT<Observer>::evict() {
+    // The victim is the LRU block of the lowest non-empty queue
+    int k = 0;
+    while (k < queues && Q[k].empty()) k++;
+    if (k == queues) return;
+    long long int victim = Q[k].back();
+    Q[k].pop_back();
+    Block b = blocks.at(victim);
+    blocks.erase(victim);
+
+    // Qout keeps its frequency, so a block that returns does not start over
+    Qout.push_front(victim);
+    History h = {Qout.begin(), b.freq, b.last};
+    history[victim] = h;
+    trim_history();
+
+    if (b.dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(victim, b.dirty);
+    observer.evict(victim, b.dirty);
+}
+
+template <class Observer>
+void MQCacheT<Observer>::adjust() {
+    // A block not referenced within its lifetime drops one queue. The lifetime is
+    // the current one, which the adaptive mode changes; touched only grows toward
+    // the MRU end, so the LRU end of each queue expires first whatever the lifetime,
+    // and this is O(m) per reference
+    for (int k = 1; k < queues; k++) {
+        if (Q[k].empty()) continue;
+        long long int y = Q[k].back();
+        Block& b = blocks.at(y);
+        if (b.touched + lifeTime < time) {
+            Q[k].pop_back();
+            Q[k - 1].push_front(y);
+            b.pos = Q[k - 1].begin();
+            b.queue = k - 1;
+            b.touched = time;
+            demotions++;
+        }
+    }
+}
+
+template <class Observer>
+void MQCacheT<Observer>::observe(long long int distance) {
+    if (!adaptive || distance <= 0) return;
+    distances[63 - __builtin_clzll((unsigned long long)distance)]++;
+    // every C references, the lifetime covers the most common temporal distance
+    if (++sinceTune < csize) return;
+    int peak = (int)(std::max_element(distances.begin(), distances.end()) - distances.begin());
+    lifeTime = (int)min(1LL << (peak + 1), (long long int)0x40000000);
+    for (int i = 0; i < MQ_DISTANCE_CLASSES; i++) distances[i] /= 2;
+    sinceTune = 0;
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core MQ Logic)
+// ------------------------------------------------------------------
+template <class Observer>
+bool MQCacheT<Observer>::refer(long long int x, string rwtype) {
+    calls++;
+    time++;
+    bool hit = false;
+
+    typename std::unordered_map<long long int, Block>::iterator it = blocks.find(x);
+    if (it != blocks.end()) {
+        // === HIT: one more reference, possibly a higher queue ===
+        hits++;
+        hit = true;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
+        Block& b = it->second;
+        observe(time - b.last);
+        Q[b.queue].erase(b.pos);
+        b.freq++;
+        int from = b.queue;
+        b.queue = queue_of(b.freq);
+        if (b.queue > from) observer.promote(x);
+        Q[b.queue].push_front(x);
+        b.pos = Q[b.queue].begin();
+        b.touched = time;
+        b.last = time;
+        if (rwtype == "Write") b.dirty = true;
+    } else {
+        // === MISS: the frequency is restored from Qout if the block was seen recently ===
+        observer.miss(x, rwtype);
+        int freq = 1;
+        typename std::unordered_map<long long int, History>::iterator h = history.find(x);
+        if (h != history.end()) {
+            observer.ghostHit(x);
+            freq = h->second.freq + 1;
+            observe(time - h->second.last);
+            Qout.erase(h->second.pos);
+            history.erase(h);
+        }
+        if ((int)blocks.size() >= csize) {
+            evict();
+        }
+        insert(x, freq, time, rwtype == "Write");
+        observer.insert(x);
+        migration++;
+        total_migration++;
+    }
+
+    adjust();
+    return hit;
+}
+
+template <class Observer>
+bool MQCacheT<Observer>::contains(long long int x) {
+    return blocks.count(x) > 0;
+}
+
+template <class Observer>
+bool MQCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool MQCacheT<Observer>::remove(long long int x) {
+    typename std::unordered_map<long long int, Block>::iterator it = blocks.find(x);
+    if (it == blocks.end()) return false;
+    // The block leaves without a Qout entry, it was not evicted by MQ
+    bool dirty = it->second.dirty;
+    Q[it->second.queue].erase(it->second.pos);
+    blocks.erase(it);
+    return dirty;
+}
+
+template <class Observer>
+long long int MQCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::resize(int n) {
+    csize = n;
+    while ((int)blocks.size() > csize) {
+        evict();
+    }
+    // Qout shrinks with the cache
+    historyLimit = history_cap((long long int)MQ_HISTORY_FACTOR * csize);
+    trim_history();
+}
+
+// ------------------------------------------------------------------
+// Snapshot: the queue count and lifetime state, every queue from its LRU end,
+// then Qout oldest first
+// ------------------------------------------------------------------
+template <class Observer>
+bool MQCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "MQ", csize);
+    snap_put(out, queues);
+    snap_put(out, lifeTime);
+    snap_put(out, time);
+    snap_put(out, sinceTune);
+    for (int i = 0; i < MQ_DISTANCE_CLASSES; i++) snap_put(out, distances[i]);
+    for (int k = 0; k < queues; k++) {
+        snap_put(out, (long long int)Q[k].size());
+        for (std::list<long long int>::reverse_iterator it = Q[k].rbegin(); it != Q[k].rend(); it++) {
+            const Block& b = blocks.at(*it);
+            snap_put_entry(out, *it, b.dirty);
+            snap_put(out, b.freq);
+            snap_put(out, b.touched + lifeTime); // saved as the expiry under the saved lifetime
+            snap_put(out, b.last);
+        }
+    }
+    snap_put(out, (long long int)Qout.size());
+    for (std::list<long long int>::reverse_iterator it = Qout.rbegin(); it != Qout.rend(); it++) {
+        const History& h = history.at(*it);
+        snap_put(out, *it);
+        snap_put(out, h.freq);
+        snap_put(out, h.last);
+    }
+    return (bool)out;
+}
+
+template <class Observer>
+bool MQCacheT<Observer>::load(std::istream& in) {
+    int m = 0;
+    if (!snap_check(in, "MQ", csize) || !snap_get(in, m)) return false;
+    if (m != queues) {
+        std::cerr << "error: snapshot holds MQ with " << m << " queues, cannot restore it into " << queues << " queues" << std::endl;
+        return false;
+    }
+    if (!snap_get(in, lifeTime) || !snap_get(in, time) || !snap_get(in, sinceTune)) return false;
+    for (int i = 0; i < MQ_DISTANCE_CLASSES; i++) {
+        if (!snap_get(in, distances[i])) return false;
+    }
+
+    blocks.clear();
+    Qout.clear();
+    history.clear();
+    for (int k = 0; k < queues; k++) {
+        Q[k].clear();
+        long long int n = 0;
+        if (!snap_get(in, n)) return false;
+        for (long long int i = 0; i < n; i++) {
+            Block b;
+            long long int x;
+            long long int expire = 0;
+            if (!snap_get_entry(in, x, b.dirty) || !snap_get(in, b.freq) || !snap_get(in, expire) || !snap_get(in, b.last)) return false;
+            b.touched = expire - lifeTime;
+            // a demoted block sits below its frequency's queue, so the queue is kept as saved
+            Q[k].push_front(x);
+            b.pos = Q[k].begin();
+            b.queue = k;
+            blocks[x] = b;
+        }
+    }
+    long long int n = 0;
+    if (!snap_get(in, n)) return false;
+    for (long long int i = 0; i < n; i++) {
+        History h;
+        long long int x;
+        if (!snap_get(in, x) || !snap_get(in, h.freq) || !snap_get(in, h.last)) return false;
+        Qout.push_front(x);
+        h.pos = Qout.begin();
+        history[x] = h;
+    }
+    // a snapshot taken without the budget is trimmed to it
+    trim_history();
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int MQCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // Every reference advances the clock that drives demotion,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+
+// ------------------------------------------------------------------
+// Remaining Required Methods
+// ------------------------------------------------------------------
+template <class Observer>
+void MQCacheT<Observer>::display() {
+	std::cout << "MQ Cache displayed." << std::endl;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "queues:";
+	for (int k = 0; k < queues; k++) std::cout << " " << Q[k].size();
+	std::cout<< ", demotions: " << demotions << ", lifeTime: " << lifeTime << ", history: " << Qout.size() << std::endl;
+
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result <<  "MQ " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " queues " << queues << " lifeTime " << lifeTime << " demotions " << demotions << "\n" ;
+	}
+	result.close();
+	report_budget("MQ", (long long int)Qout.size(), trimmed);
+}
+
+template <class Observer>
+void MQCacheT<Observer>::refresh(){
+	calls = 0;
+	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	demotions = 0;
+	trimmed = 0;
+	migration = 0;
+}
+
+template <class Observer>
+void MQCacheT<Observer>::summary() {
+	// print the number of total cache calls, hits, and data migration size
+}
+
+// The observers the simulator is built with (observer.h)
+template class MQCacheT<NullObserver>;
+template class MQCacheT<EventRecorder>;
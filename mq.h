@@ -0,0 +1,106 @@
+/* mq.h - MQ (Multi-Queue) Cache Policy for second-level buffer caches */
+#include <string>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "budget.h"
+using namespace std;
+#ifndef _mq_H
+#define _mq_H
+
+#define MQ_QUEUES 8          // LRU queues Q0..Qm-1, block with frequency f lives in Q[min(log2 f, m-1)]
+#define MQ_HISTORY_FACTOR 4  // Qout remembers the frequencies of this many times C evicted blocks
+#define MQ_DISTANCE_CLASSES 64 // temporal distance histogram, one class per power of two
+
+// Defaults for caches built from just a size (command line -q), shared by every
+// MQCacheT whatever its observer
+struct MQDefaults
+{
+    static int defaultQueues;
+    static int defaultLifeTime;
+};
+
+template <class Observer = NullObserver>
+class MQCacheT : private MQDefaults
+{
+private:
+    int csize;    // Maximum capacity of the cache (C)
+    int queues;   // number of LRU queues (m)
+    int lifeTime; // references a block may stay unreferenced before it is demoted one queue
+    bool adaptive; // lifeTime follows the peak temporal distance of the workload
+
+    // Resident blocks
+    struct Block {
+        std::list<long long int>::iterator pos;
+        int queue;
+        int freq;
+        long long int touched; // time it was put at the front of its queue: referenced, inserted or demoted
+        long long int last;    // time of the last reference
+        bool dirty;
+    };
+    std::vector<std::list<long long int> > Q; // each queue MRU first
+    std::unordered_map<long long int, Block> blocks;
+
+    // Qout: history of evicted blocks and their frequencies, newest first
+    struct History {
+        std::list<long long int>::iterator pos;
+        int freq;
+        long long int last;
+    };
+    std::list<long long int> Qout;
+    std::unordered_map<long long int, History> history;
+    long long int historyLimit; // Qout entries: MQ_HISTORY_FACTOR * C, or the metadata budget if smaller
+    long long int trimmed;      // Qout entries dropped because of the budget
+
+    // Temporal distance between references to the same block, for the adaptive lifeTime
+    std::vector<long long int> distances;
+    long long int sinceTune;
+    long long int time; // references seen
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int demotions; // blocks moved down a queue because their lifetime expired
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
+    long long int migration, total_migration;
+
+    // Helper functions for the MQ policy
+    int queue_of(int freq);
+    void insert(long long int, int, long long int, bool);
+    void trim_history();
+    void evict();
+    void adjust();
+    void observe(long long int);
+
+public:
+    MQCacheT(int);
+    MQCacheT(int, int, int);
+    ~MQCacheT();
+    static void setDefaults(int queues, int lifeTime); // lifeTime 0 adapts to the workload
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts from the lowest queues
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+
+typedef MQCacheT<> MQCache;
+#endif
@@ -0,0 +1,137 @@
+/* observer.h - Policy events: a compile-time observer sees every hit, miss, insert, eviction, ghost hit and promotion */
+#include <stdio.h>
+#include <stdint.h>
+#include <iostream>
+#include <string>
+using namespace std;
+#ifndef _observer_H
+#define _observer_H
+
+// Events, as stored in the low bits of a log record's tag byte
+enum PolicyEvent {
+    EVENT_HIT = 0,       // a demand reference found the page (flag: write)
+    EVENT_MISS = 1,      // a demand reference did not (flag: write)
+    EVENT_INSERT = 2,    // the page was placed in the cache (a miss, a prefetch or a tier fill)
+    EVENT_EVICT = 3,     // the page left the cache (flag: dirty)
+    EVENT_GHOST_HIT = 4, // a miss on a page the policy's history still remembered
+    EVENT_PROMOTE = 5,   // the page moved to a more protected segment or queue
+    EVENT_CACHE = 7,     // the following events come from another cache instance (tiers, tenants)
+    EVENT_KINDS = 8
+};
+
+// The default observer. Every hook is an empty inline function, so a policy built
+// with it compiles to the same code as one without any hooks (the access type is
+// passed as it is, so not even the read/write test is left behind).
+struct NullObserver
+{
+    void installing(bool) {}
+    void hit(long long int, const string&) {}
+    void miss(long long int, const string&) {}
+    void insert(long long int) {}
+    void evict(long long int, bool) {}
+    void ghostHit(long long int) {}
+    void promote(long long int) {}
+};
+
+// Binary event log (command line -O). After an 8-byte header ("CEVLOG1\n") every
+// record is a tag byte, event in bits 0-2 and the flag in bit 3, followed by the
+// key as a zigzag LEB128 varint of its difference from the previous record's key;
+// an EVENT_CACHE record carries the instance number instead. Most records take
+// two to four bytes.
+class EventLog
+{
+private:
+    FILE* file;
+    unsigned char buffer[1 << 16];
+    size_t used;
+    long long int previous; // key of the last record, the next one is stored relative to it
+    int current;            // cache instance of the last record
+    int instances;
+    long long int counts[EVENT_KINDS];
+    long long int bytes;
+
+    void put(unsigned char c) {
+        if (used == sizeof(buffer)) flush();
+        buffer[used++] = c;
+    }
+    void put_varint(unsigned long long v) {
+        while (v >= 0x80) {
+            put((unsigned char)(v | 0x80));
+            v >>= 7;
+        }
+        put((unsigned char)v);
+    }
+    void flush() {
+        if (file && used > 0) fwrite(buffer, 1, used, file);
+        bytes += used;
+        used = 0;
+    }
+
+public:
+    EventLog() : file(NULL), used(0), previous(0), current(-1), instances(0), bytes(0) {
+        for (int i = 0; i < EVENT_KINDS; i++) counts[i] = 0;
+    }
+    ~EventLog() {
+        close();
+    }
+
+    // The one log every recording observer writes to
+    static EventLog& get() {
+        static EventLog log;
+        return log;
+    }
+
+    bool open(const char* path) {
+        file = fopen(path, "wb");
+        if (!file) return false;
+        fwrite("CEVLOG1\n", 1, 8, file);
+        bytes = 8;
+        return true;
+    }
+
+    void close() {
+        if (!file) return;
+        flush();
+        fclose(file);
+        file = NULL;
+        std::cout << "event log: hits " << counts[EVENT_HIT] << ", misses " << counts[EVENT_MISS] << ", inserts " << counts[EVENT_INSERT] << ", evictions " << counts[EVENT_EVICT] << ", ghostHits " << counts[EVENT_GHOST_HIT] << ", promotions " << counts[EVENT_PROMOTE] << ", caches " << instances << ", bytes " << bytes << std::endl;
+    }
+
+    int instance() {
+        return instances++;
+    }
+
+    void record(int cache, int event, long long int key, bool flag) {
+        if (!file) return;
+        if (cache != current) {
+            put(EVENT_CACHE);
+            put_varint((unsigned long long)cache);
+            current = cache;
+        }
+        put((unsigned char)(event | (flag ? 8 : 0)));
+        long long int delta = key - previous;
+        put_varint(((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63));
+        previous = key;
+        counts[event]++;
+    }
+};
+
+// Records every event of the cache it belongs to in the event log. Installs
+// (prefetches, tier fills) go through the policies' refer(), but are not demand
+// references, so their hit and miss are left out; the insert is kept.
+struct EventRecorder
+{
+    int cache;
+    bool quiet;
+
+    EventRecorder() : cache(EventLog::get().instance()), quiet(false) {}
+
+    void installing(bool on) { quiet = on; }
+    void hit(long long int key, const string& rwtype) { if (!quiet) EventLog::get().record(cache, EVENT_HIT, key, rwtype != "Read"); }
+    void miss(long long int key, const string& rwtype) { if (!quiet) EventLog::get().record(cache, EVENT_MISS, key, rwtype != "Read"); }
+    void insert(long long int key) { EventLog::get().record(cache, EVENT_INSERT, key, false); }
+    void evict(long long int key, bool dirty) { EventLog::get().record(cache, EVENT_EVICT, key, dirty); }
+    void ghostHit(long long int key) { EventLog::get().record(cache, EVENT_GHOST_HIT, key, false); }
+    void promote(long long int key) { EventLog::get().record(cache, EVENT_PROMOTE, key, false); }
+};
+#endif
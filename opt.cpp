@@ -0,0 +1,266 @@
+/* opt.cpp - Belady's OPT (MIN) offline oracle Implementation */
+
+#include <iostream>
+#include <fstream>
+#include "opt.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+OPTCache::OPTCache(int n) {
+    csize = n;
+    keys = tmpfile();
+    nextUses = tmpfile();
+    references = 0;
+    position = 0;
+    chunkPos = 0;
+
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    bypassed = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    if (!keys || !nextUses) {
+        std::cerr << "error: OPT cannot create its temporary reference files" << std::endl;
+    }
+    std::cout << "OPT (Belady) Algorithm is used" << std::endl;
+    std::cout << "Cache size is: " << csize << std::endl;
+}
+
+OPTCache::~OPTCache() {
+    if (keys) fclose(keys);
+    if (nextUses) fclose(nextUses);
+    resident.clear();
+}
+
+// ------------------------------------------------------------------
+// Offline passes
+// ------------------------------------------------------------------
+void OPTCache::record(long long int offset, int length) {
+    if (length <= 0 || !keys) return;
+    // same page split as refer_range, so positions line up with the replay
+    long long int first = offset - offset % page_size;
+    int n = (int)((offset + length - 1) / page_size - offset / page_size + 1);
+    for (int i = 0; i < n; i++) {
+        long long int x = first + (long long int)i * page_size;
+        fwrite(&x, sizeof(x), 1, keys);
+    }
+    references += n;
+}
+
+void OPTCache::prepare() {
+    if (!keys || !nextUses) return;
+    // Backward pass, one chunk at a time from the end of the reference string:
+    // each reference's next use is the position where its page was last seen
+    std::unordered_map<long long int, long long int> seen;
+    std::vector<long long int> buffer(OPT_CHUNK);
+    long long int end = references;
+    while (end > 0) {
+        long long int begin = (end > OPT_CHUNK) ? end - OPT_CHUNK : 0;
+        size_t n = (size_t)(end - begin);
+        fseek(keys, begin * (long long int)sizeof(long long int), SEEK_SET);
+        n = fread(&buffer[0], sizeof(long long int), n, keys);
+        for (long long int i = (long long int)n - 1; i >= 0; i--) {
+            long long int x = buffer[i];
+            std::unordered_map<long long int, long long int>::iterator it = seen.find(x);
+            long long int next = (it == seen.end()) ? OPT_NEVER : it->second;
+            seen[x] = begin + i;
+            buffer[i] = next;
+        }
+        fseek(nextUses, begin * (long long int)sizeof(long long int), SEEK_SET);
+        fwrite(&buffer[0], sizeof(long long int), n, nextUses);
+        end = begin;
+    }
+    rewind(nextUses);
+    std::cout << "OPT prepared " << references << " references to " << seen.size() << " distinct pages" << std::endl;
+}
+
+long long int OPTCache::nextUse() {
+    // Forward pass: stream the next-use positions in the order they were recorded
+    if (chunkPos == chunk.size()) {
+        chunk.resize(OPT_CHUNK);
+        size_t n = nextUses ? fread(&chunk[0], sizeof(long long int), OPT_CHUNK, nextUses) : 0;
+        chunk.resize(n);
+        chunkPos = 0;
+        if (n == 0) {
+            // replayed past the recorded string: behave as if the page is never reused
+            position++;
+            return OPT_NEVER;
+        }
+    }
+    position++;
+    return chunk[chunkPos++];
+}
+
+// ------------------------------------------------------------------
+// OPT Helper Functions
+// ------------------------------------------------------------------
+void OPTCache::evict(long long int victim, bool dirty) {
+    if (dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(victim, dirty);
+}
+
+void OPTCache::compact() {
+    // Rebuild the heap from the resident blocks once stale entries dominate it
+    std::vector<std::pair<long long int, long long int> > live;
+    live.reserve(resident.size());
+    for (std::unordered_map<long long int, Entry>::iterator it = resident.begin(); it != resident.end(); ++it) {
+        live.push_back(std::make_pair(it->second.next, it->first));
+    }
+    farthest = std::priority_queue<std::pair<long long int, long long int> >(live.begin(), live.end());
+}
+
+// ------------------------------------------------------------------
+// Main OPT Logic
+// ------------------------------------------------------------------
+bool OPTCache::refer(long long int x, string rwtype) {
+    calls++;
+    long long int next = nextUse();
+
+    std::unordered_map<long long int, Entry>::iterator it = resident.find(x);
+    if (it != resident.end()) {
+        hits++;
+        if (rwtype == "Read") {
+            readHits++;
+        } else {
+            writeHits++;
+            it->second.dirty = true;
+        }
+        it->second.next = next;
+        farthest.push(std::make_pair(next, x));
+        if (farthest.size() > 4 * (size_t)csize + 16) compact();
+        return true;
+    }
+
+    bool dirty = (rwtype == "Write");
+    if (csize <= 0) {
+        evict(x, dirty);
+        return false;
+    }
+    if ((int)resident.size() >= csize) {
+        // skip stale heap entries until the top is a resident block at its current next use
+        while (true) {
+            std::pair<long long int, long long int> top = farthest.top();
+            std::unordered_map<long long int, Entry>::iterator victim = resident.find(top.second);
+            if (victim != resident.end() && victim->second.next == top.first) break;
+            farthest.pop();
+        }
+        // MIN: the incoming page competes too; if it is reused last it is not kept
+        if (next >= farthest.top().first) {
+            bypassed++;
+            evict(x, dirty);
+            return false;
+        }
+        long long int victim = farthest.top().second;
+        farthest.pop();
+        evict(victim, resident[victim].dirty);
+        resident.erase(victim);
+    }
+
+    Entry e = {next, dirty};
+    resident[x] = e;
+    farthest.push(std::make_pair(next, x));
+    return false;
+}
+
+int OPTCache::refer_range(long long int offset, int length, string rwtype) {
+    if (length <= 0) return 0;
+    // align to whole pages so the same physical page always maps to the same key
+    long long int first = offset - offset % page_size;
+    int n = (int)((offset + length - 1) / page_size - offset / page_size + 1);
+    int hitPages = 0;
+    for (int i = 0; i < n; i++) {
+        if (refer(first + (long long int)i * page_size, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+bool OPTCache::contains(long long int x) {
+    return resident.count(x) > 0;
+}
+
+bool OPTCache::install(long long int /*x*/, string /*rwtype*/) {
+    // An installed page has no position in the recorded reference string
+    return false;
+}
+
+bool OPTCache::remove(long long int x) {
+    std::unordered_map<long long int, Entry>::iterator it = resident.find(x);
+    if (it == resident.end()) return false;
+    // its heap entry turns stale and is skipped later
+    bool dirty = it->second.dirty;
+    resident.erase(it);
+    return dirty;
+}
+
+long long int OPTCache::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+void OPTCache::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+void OPTCache::setPageSize(int n) {
+    page_size = n;
+}
+
+bool OPTCache::save(std::ostream& /*out*/) {
+    // OPT's state is a position in one recorded trace, it cannot seed another run
+    std::cerr << "error: OPT state cannot be snapshotted" << std::endl;
+    return false;
+}
+
+bool OPTCache::load(std::istream& /*in*/) {
+    std::cerr << "error: OPT state cannot be restored from a snapshot" << std::endl;
+    return false;
+}
+
+// ------------------------------------------------------------------
+// Utility Functions
+// ------------------------------------------------------------------
+void OPTCache::display() {
+    for (std::unordered_map<long long int, Entry>::iterator it = resident.begin(); it != resident.end(); ++it) {
+        std::cout << it->first << " ";
+    }
+    std::cout << std::endl;
+}
+
+void OPTCache::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+    std::cout << "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " << writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+    std::cout << "bypassed: " << bypassed << std::endl;
+    if (position != references) {
+        std::cerr << "warning: OPT replayed " << position << " references but recorded " << references << std::endl;
+    }
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << "OPT " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " bypassed " << bypassed << "\n";
+    }
+    result.close();
+}
+
+void OPTCache::refresh() {
+    calls = 0;
+    hits = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    bypassed = 0;
+}
+
+void OPTCache::summary() {
+    std::cout << "the total number of cache hits is: " << total_hits << std::endl;
+    std::cout << "the total number of total refered calls is " << total_calls << std::endl;
+}
@@ -0,0 +1,78 @@
+/* opt.h - Belady's OPT (MIN) offline oracle: evicts the block whose next use is farthest away */
+#include <string>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <stdio.h>
+#include "evictsink.h"
+#include "snapshot.h"
+using namespace std;
+#ifndef _opt_H
+#define _opt_H
+
+#define OPT_CHUNK (1 << 20)    // references per chunk of the next-use passes (8MB of buffer)
+#define OPT_NEVER 0x7fffffffffffffffLL // next use of a block that is never referenced again
+
+class OPTCache
+{
+private:
+    int csize; // Maximum capacity of the cache (C)
+
+    // The page reference string and each reference's next-use position live in
+    // temporary files and are streamed a chunk at a time, so the trace does not
+    // have to fit in memory; only one position per distinct page is kept.
+    FILE* keys;      // page keys, in reference order (filled by record)
+    FILE* nextUses;  // next-use position of each reference (filled by prepare)
+    long long int references; // length of the reference string
+    long long int position;   // index of the next reference to be served
+    std::vector<long long int> chunk; // forward pass buffer of next-use positions
+    size_t chunkPos;
+
+    struct Entry {
+        long long int next; // position of the block's next reference
+        bool dirty;
+    };
+    std::unordered_map<long long int, Entry> resident;
+
+    // Max-heap of (next use, key); an entry is stale once the block has been
+    // referenced again or evicted, and is skipped when it reaches the top
+    std::priority_queue<std::pair<long long int, long long int> > farthest;
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int bypassed; // misses never installed, because the page is reused later than everything resident
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    int page_size; // keys are page-aligned byte addresses
+
+    long long int nextUse();
+    void evict(long long int, bool);
+    void compact();
+
+public:
+    OPTCache(int);
+    ~OPTCache();
+
+    // Offline preparation: record the whole reference string, then compute next uses
+    void record(long long int, int); // one request, split into pages like refer_range
+    void prepare();
+
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // OPT knows only the recorded references, nothing can be installed
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+#endif
@@ -0,0 +1,117 @@
+/* partition.cpp - Key-hash partitioning of one trace Implementation */
+
+#include <iostream>
+#include <algorithm>
+#include <stdint.h>
+#include "partition.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Request queue
+// ------------------------------------------------------------------
+RequestQueue::RequestQueue() {
+    closed = false;
+}
+
+void RequestQueue::push(std::vector<TraceRequest>& batch) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (batches.size() >= PARTITION_QUEUE_BATCHES) changed.wait(guard);
+    batches.push_back(std::vector<TraceRequest>());
+    batches.back().swap(batch);
+    changed.notify_all();
+}
+
+bool RequestQueue::pop(std::vector<TraceRequest>& batch) {
+    std::unique_lock<std::mutex> guard(lock);
+    while (batches.empty() && !closed) changed.wait(guard);
+    if (batches.empty()) return false;
+    batch.swap(batches.front());
+    batches.pop_front();
+    changed.notify_all();
+    return true;
+}
+
+void RequestQueue::close() {
+    std::unique_lock<std::mutex> guard(lock);
+    closed = true;
+    changed.notify_all();
+}
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+Partitioner::Partitioner(int k, int pageSize, std::vector<RequestQueue>& q) : queues(q) {
+    shards = k;
+    stripeBytes = (long long int)pageSize * PARTITION_STRIPE_PAGES;
+    pending.resize(shards);
+    pieces.assign(shards, 0);
+    splitRequests = 0;
+}
+
+Partitioner::~Partitioner() {
+    pending.clear();
+}
+
+// ------------------------------------------------------------------
+// Partitioning
+// ------------------------------------------------------------------
+int Partitioner::shardOf(long long int stripe) {
+    // splitmix64 finaliser spreads neighbouring stripes over the shards
+    uint64_t z = (uint64_t)stripe + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= (z >> 31);
+    return (int)(z % (uint64_t)shards);
+}
+
+void Partitioner::send(int shard, double time, long long int offset, int size, const string& rwtype) {
+    TraceRequest r = {time, offset, size, rwtype};
+    pending[shard].push_back(r);
+    pieces[shard]++;
+    if ((int)pending[shard].size() >= PARTITION_BATCH) {
+        queues[shard].push(pending[shard]);
+        pending[shard].clear();
+    }
+}
+
+void Partitioner::operator()(double time, long long int offset, int size, string rwtype, const string& /*tenant*/) {
+    if (size <= 0) {
+        return;
+    }
+    long long int end = offset + size;
+    bool split = false;
+    while (offset < end) {
+        // consecutive stripes of the same shard stay one request
+        int shard = shardOf(offset / stripeBytes);
+        long long int stop = min(end, (offset / stripeBytes + 1) * stripeBytes);
+        while (stop < end && shardOf(stop / stripeBytes) == shard) stop = min(end, stop + stripeBytes);
+        if (stop < end) split = true;
+        send(shard, time, offset, (int)(stop - offset), rwtype);
+        offset = stop;
+    }
+    if (split) splitRequests++;
+}
+
+void Partitioner::finish() {
+    for (int i = 0; i < shards; i++) {
+        if (!pending[i].empty()) queues[i].push(pending[i]);
+        queues[i].close();
+    }
+}
+
+// ------------------------------------------------------------------
+// Reporting
+// ------------------------------------------------------------------
+void Partitioner::report() {
+    long long int total = 0;
+    long long int largest = 0;
+    for (int i = 0; i < shards; i++) {
+        total += pieces[i];
+        largest = max(largest, pieces[i]);
+    }
+    // Imbalance: the busiest shard's share relative to a perfectly even split
+    double imbalance = (total > 0) ? (double)largest * shards / total : 0.0;
+    std::cout << "shards: " << shards << ", requests per shard:";
+    for (int i = 0; i < shards; i++) std::cout << " " << pieces[i];
+    std::cout << ", imbalance: " << imbalance << ", splitRequests: " << splitRequests << std::endl;
+}
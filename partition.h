@@ -0,0 +1,64 @@
+/* partition.h - Key-hash partitioning of one trace into K independently replayed streams */
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+#ifndef _partition_H
+#define _partition_H
+
+#define PARTITION_STRIPE_PAGES 256 // pages hashed together (1MB of 4KB pages), so most requests stay on one shard
+#define PARTITION_BATCH 4096       // requests handed to a shard at a time
+#define PARTITION_QUEUE_BATCHES 16 // batches buffered per shard before the parser waits
+
+struct TraceRequest {
+    double time;
+    long long int offset;
+    int size;
+    string rwtype;
+};
+
+// Bounded queue of request batches between the parser and one shard's replay thread
+class RequestQueue
+{
+private:
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::vector<TraceRequest> > batches;
+    bool closed;
+
+public:
+    RequestQueue();
+    void push(std::vector<TraceRequest>&); // takes the batch's contents, waits while the queue is full
+    bool pop(std::vector<TraceRequest>&);  // false once the queue is closed and empty
+    void close();
+};
+
+// Trace handler that splits each request at stripe boundaries and sends
+// every piece to the shard its stripe hashes to
+class Partitioner
+{
+private:
+    int shards;
+    long long int stripeBytes;
+    std::vector<RequestQueue>& queues;
+    std::vector<std::vector<TraceRequest> > pending;
+
+    // Statistics
+    std::vector<long long int> pieces; // requests (or request pieces) sent to each shard
+    long long int splitRequests;       // requests whose stripes went to more than one shard
+
+    int shardOf(long long int stripe);
+    void send(int shard, double time, long long int offset, int size, const string& rwtype);
+
+public:
+    Partitioner(int, int, std::vector<RequestQueue>&);
+    ~Partitioner();
+
+    void operator()(double time, long long int offset, int size, string rwtype, const string& tenant);
+    void finish(); // flush the last batches and close every queue
+
+    void report();
+};
+#endif
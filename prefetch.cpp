@@ -0,0 +1,136 @@
+/* prefetch.cpp - Sequential readahead engine Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "prefetch.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+Prefetcher::Prefetcher(int n, int page) {
+    depth = n;
+    pageSize = page;
+    clock = 0;
+    settled = 0;
+
+    Stream empty;
+    empty.next = -1;
+    empty.ahead = -1;
+    empty.run = 0;
+    empty.lastUse = 0;
+    streams.assign(PF_STREAMS, empty);
+
+    demandPages = 0;
+    demandMisses = 0;
+    issued = 0;
+    prefetchHits = 0;
+    wasted = 0;
+    unused = 0;
+
+    std::cout << "Sequential prefetch: depth " << depth << " pages, " << PF_STREAMS << " streams, trigger after " << PF_TRIGGER << " sequential requests" << std::endl;
+}
+
+Prefetcher::~Prefetcher() {
+    streams.clear();
+    outstanding.clear();
+    predicted.clear();
+}
+
+// ------------------------------------------------------------------
+// Stream detection
+// ------------------------------------------------------------------
+void Prefetcher::demand(long long int page, bool resident) {
+    if (outstanding.empty()) return;
+    std::unordered_set<long long int>::iterator it = outstanding.find(page);
+    if (it == outstanding.end()) return;
+    outstanding.erase(it);
+    // The first demand reference decides whether the prefetch paid off
+    if (resident) prefetchHits++;
+    else wasted++;
+}
+
+const std::vector<long long int>& Prefetcher::access(long long int offset, int pages, int hitPages) {
+    predicted.clear();
+    if (pages <= 0) return predicted;
+    clock++;
+    demandPages += pages;
+    demandMisses += pages - hitPages;
+
+    long long int first = offset - offset % pageSize;
+    long long int next = first + (long long int)pages * pageSize;
+
+    // A request continues a stream if it starts where the stream expects,
+    // or inside the stream's last page when requests are not page aligned
+    int s = -1;
+    for (int i = 0; i < PF_STREAMS; i++) {
+        if (streams[i].run > 0 && (first == streams[i].next || first == streams[i].next - pageSize)) {
+            s = i;
+            break;
+        }
+    }
+
+    if (s >= 0) {
+        Stream& st = streams[s];
+        st.run++;
+        st.next = next;
+        st.lastUse = clock;
+        if (st.run >= PF_TRIGGER) {
+            // Keep the stream 'depth' pages ahead, only issuing pages not read ahead before
+            long long int end = st.next + (long long int)depth * pageSize;
+            for (long long int p = max(st.next, st.ahead); p < end; p += pageSize) {
+                predicted.push_back(p);
+            }
+            st.ahead = max(st.ahead, end);
+        }
+    } else if (hitPages < pages) {
+        // Only misses start a new stream; it replaces the least recently used one
+        int victim = 0;
+        for (int i = 1; i < PF_STREAMS; i++) {
+            if (streams[i].lastUse < streams[victim].lastUse) victim = i;
+        }
+        Stream& st = streams[victim];
+        st.next = next;
+        st.ahead = next;
+        st.run = 1;
+        st.lastUse = clock;
+    }
+    return predicted;
+}
+
+void Prefetcher::installed(long long int page) {
+    issued++;
+    // Still outstanding means the earlier prefetch of this page was evicted unused
+    if (!outstanding.insert(page).second) wasted++;
+}
+
+// ------------------------------------------------------------------
+// Reporting
+// ------------------------------------------------------------------
+void Prefetcher::report(string policy) {
+    // accuracy: share of prefetched pages that served a demand reference
+    // coverage: share of would-be demand misses removed by prefetching
+    float accuracy = (issued > 0) ? (float)prefetchHits / issued : 0.0;
+    float coverage = (demandMisses + prefetchHits > 0) ? (float)prefetchHits / (demandMisses + prefetchHits) : 0.0;
+
+    std::cout << "demandReadPages: " << demandPages << ", demandReadMisses: " << demandMisses << ", prefetchIssued(extra reads): " << issued << ", prefetchHits: " << prefetchHits << ", wastedPrefetches: " << wasted << ", unusedResident: " << unused << ", accuracy: " << accuracy << ", coverage: " << coverage << std::endl;
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << policy << " Prefetch" << " depth " << depth << " demandReadPages " << demandPages << " demandReadMisses " << demandMisses << " prefetchIssued " << issued << " prefetchHits " << prefetchHits << " wastedPrefetches " << wasted << " unusedResident " << unused << " accuracy " << accuracy << " coverage " << coverage << "\n";
+    }
+    result.close();
+}
+
+void Prefetcher::refresh() {
+    // prefetches issued before the reset are no longer counted as issued, nor as hits
+    outstanding.clear();
+    settled = 0;
+    demandPages = 0;
+    demandMisses = 0;
+    issued = 0;
+    prefetchHits = 0;
+    wasted = 0;
+    unused = 0;
+}
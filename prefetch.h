@@ -0,0 +1,85 @@
+/* prefetch.h - Sequential readahead engine layered over any cache policy */
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "budget.h"
+using namespace std;
+#ifndef _prefetch_H
+#define _prefetch_H
+
+#define PF_STREAMS 16 // sequential streams tracked at once
+#define PF_TRIGGER 2  // consecutive sequential requests before readahead starts
+
+class Prefetcher
+{
+private:
+    int depth;    // pages read ahead of a detected stream
+    int pageSize; // distance between consecutive page keys
+
+    // A stream expects its next request at 'next' and has been read ahead up to 'ahead'
+    struct Stream {
+        long long int next;
+        long long int ahead;
+        int run;
+        long long int lastUse;
+    };
+    std::vector<Stream> streams;
+    long long int clock;
+
+    // Prefetched pages that no demand reference has touched yet
+    std::unordered_set<long long int> outstanding;
+    size_t settled; // outstanding pages left after the last settle()
+    // Pages the caller should install into the policy after the current request
+    std::vector<long long int> predicted;
+
+    // Statistics
+    long long int demandPages;  // pages of read requests (the streams readahead follows)
+    long long int demandMisses;
+    long long int issued;       // prefetched pages installed, each one an extra backing-device read
+    long long int prefetchHits; // demand references served by a prefetched page
+    long long int wasted;       // prefetched pages evicted before any demand reference
+    long long int unused;       // prefetched pages still resident but never referenced at the end
+
+public:
+    Prefetcher(int, int);
+    ~Prefetcher();
+
+    // Called for each page of a request before it is served: is the page an outstanding prefetch?
+    void demand(long long int page, bool resident);
+    // Called after a request is served; returns the pages to read ahead
+    const std::vector<long long int>& access(long long int offset, int pages, int hitPages);
+    // Called for every predicted page the policy actually installed
+    void installed(long long int);
+
+    // Under a metadata budget: forget outstanding pages the policy has already
+    // evicted, counting them as wasted now rather than at the end. The statistics
+    // do not change; the set is only swept once it has doubled since the last sweep
+    template <class Cache>
+    void settle(Cache& ca) {
+        if ((long long int)outstanding.size() <= metadata_budget() || outstanding.size() <= 2 * settled) return;
+        for (std::unordered_set<long long int>::iterator it = outstanding.begin(); it != outstanding.end(); ) {
+            if (ca.contains(*it)) {
+                ++it;
+            } else {
+                wasted++;
+                it = outstanding.erase(it);
+            }
+        }
+        settled = outstanding.size();
+    }
+
+    // Settle outstanding prefetches at the end of replay; contains() tells which are still resident
+    template <class Cache>
+    void finish(Cache& ca) {
+        for (std::unordered_set<long long int>::iterator it = outstanding.begin(); it != outstanding.end(); ++it) {
+            if (ca.contains(*it)) unused++;
+            else wasted++;
+        }
+        outstanding.clear();
+        settled = 0;
+    }
+
+    void report(string policy);
+    void refresh();
+};
+#endif
@@ -0,0 +1,284 @@
+/* regress.cpp - Regression check Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "regress.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Synthetic Traces
+// ------------------------------------------------------------------
+// Uniform double in [0, 1) from the raw generator output, which the standard fixes
+// for mt19937_64 (the library's distributions are not, so they are not used here)
+static double uniform(std::mt19937_64& rng) {
+    return (double)(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+const std::vector<string>& synthetic_traces() {
+    static std::vector<string> names;
+    if (names.empty()) {
+        names.push_back("zipf");
+        names.push_back("loop");
+        names.push_back("ranges");
+    }
+    return names;
+}
+
+void synthetic_trace(const string& name, int csize, int pageSize, std::vector<TraceRequest>& out) {
+    static const string read = "Read";
+    static const string write = "Write";
+    std::mt19937_64 rng(REGRESS_SEED);
+    out.clear();
+    TraceRequest r;
+    r.time = 0;
+
+    if (name == "zipf") {
+        // 200k single-page references, Zipf(0.9) over 20 cache sizes of pages, 30% writes
+        long long int pages = 20LL * csize;
+        std::vector<double> cdf(pages);
+        double sum = 0;
+        for (long long int i = 0; i < pages; i++) {
+            sum += 1.0 / pow((double)(i + 1), 0.9);
+            cdf[i] = sum;
+        }
+        for (int i = 0; i < 200000; i++) {
+            double u = uniform(rng) * sum;
+            long long int page = std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            if (page >= pages) page = pages - 1;
+            r.time = i * 1e-3;
+            r.offset = page * pageSize;
+            r.size = pageSize;
+            r.rwtype = (uniform(rng) < 0.3) ? write : read;
+            out.push_back(r);
+        }
+    } else if (name == "loop") {
+        // 200k single-page references: half to a hot set of half the cache, half to
+        // a sequential loop over twice the cache, which defeats recency-only policies
+        long long int hot = max(1, csize / 2);
+        long long int loop = 2LL * csize;
+        long long int next = 0;
+        for (int i = 0; i < 200000; i++) {
+            long long int page;
+            if (uniform(rng) < 0.5) {
+                page = (long long int)(uniform(rng) * hot);
+            } else {
+                page = hot + next;
+                next = (next + 1) % loop;
+            }
+            r.time = i * 1e-3;
+            r.offset = page * pageSize;
+            r.size = pageSize;
+            r.rwtype = (uniform(rng) < 0.2) ? write : read;
+            out.push_back(r);
+        }
+    } else if (name == "ranges") {
+        // 100k requests of 0.5KB to 64KB at 512-byte aligned offsets over four cache
+        // sizes of data; half of them continue the previous request, 40% are writes
+        long long int span = 4LL * csize * pageSize;
+        long long int offset = 0;
+        int size = 0;
+        for (int i = 0; i < 100000; i++) {
+            if (uniform(rng) < 0.5) {
+                offset = offset + size;
+                if (offset >= span) offset = 0;
+            } else {
+                offset = (long long int)(uniform(rng) * (span / 512)) * 512;
+            }
+            size = 512 * (1 + (int)(uniform(rng) * 128));
+            r.time = i * 1e-3;
+            r.offset = offset;
+            r.size = size;
+            r.rwtype = (uniform(rng) < 0.4) ? write : read;
+            out.push_back(r);
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Golden File: one line per run, in the ExperimentalResult.txt style
+// ------------------------------------------------------------------
+RegressionCheck::RegressionCheck(const string& goldenFile, const string& baselineFile, double percent, bool record) {
+    path = goldenFile;
+    baselinePath = baselineFile;
+    threshold = percent / 100.0;
+    recording = record;
+    mismatches = 0;
+    unknown = 0;
+    slower = 0;
+    baselined = 0;
+}
+
+string RegressionCheck::key(const RegressResult& r) {
+    std::ostringstream k;
+    k << r.trace << " " << r.policy << " " << r.csize;
+    return k.str();
+}
+
+void RegressionCheck::write(std::ostream& out, const RegressResult& r) {
+    out << r.trace << " " << r.policy << " CacheSize " << r.csize << " calls " << r.calls << " hits " << r.hits << " readHits " << r.readHits << " writeHits " << r.writeHits << " evictedDirtyPage " << r.evictedDirtyPage << " hitBytes " << r.hitBytes << "\n";
+}
+
+bool RegressionCheck::load() {
+    std::ifstream in(path.c_str());
+    if (!in.is_open()) {
+        if (recording) {
+            std::cout << "No golden results in " << path << ", recording them" << std::endl;
+        } else {
+            std::cerr << "error: unable to open golden results " << path << " (-W records them)" << std::endl;
+            return false;
+        }
+    }
+    string line;
+    int number = 0;
+    while (getline(in, line)) {
+        number++;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        RegressResult r;
+        string name[7];
+        if (!(fields >> r.trace >> r.policy >> name[0] >> r.csize >> name[1] >> r.calls >> name[2] >> r.hits
+                     >> name[3] >> r.readHits >> name[4] >> r.writeHits >> name[5] >> r.evictedDirtyPage
+                     >> name[6] >> r.hitBytes)) {
+            std::cerr << "error: " << path << " line " << number << " is not a golden result" << std::endl;
+            return false;
+        }
+        r.throughput = 0;
+        golden[key(r)] = r;
+    }
+    if (baselinePath.empty()) return true;
+
+    // throughput baselines: "trace policy CacheSize N requestsPerSecond R", recorded on this machine
+    std::ifstream base(baselinePath.c_str());
+    if (!base.is_open()) {
+        std::cout << "No throughput baselines in " << baselinePath << ", recording them" << std::endl;
+        return true;
+    }
+    number = 0;
+    while (getline(base, line)) {
+        number++;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        RegressResult r;
+        string name[2];
+        double throughput;
+        if (!(fields >> r.trace >> r.policy >> name[0] >> r.csize >> name[1] >> throughput)) {
+            std::cerr << "error: " << baselinePath << " line " << number << " is not a throughput baseline" << std::endl;
+            return false;
+        }
+        baseline[key(r)] = throughput;
+    }
+    return true;
+}
+
+bool RegressionCheck::timed() {
+    return !baselinePath.empty();
+}
+
+void RegressionCheck::check(const RegressResult& r, bool stable) {
+    results.push_back(r);
+    std::cout << r.trace << " " << r.policy << ": calls: " << r.calls << ", hits: " << r.hits << ", evictedDirtyPage: " << r.evictedDirtyPage << ", hitBytes: " << r.hitBytes;
+    if (timed()) std::cout << ", requests/s: " << (long long int)r.throughput;
+    if (!stable) {
+        // the policy depends on something other than the trace (time, addresses, uninitialised state)
+        std::cout << "  FAIL: repeats of the run disagree" << std::endl;
+        mismatches++;
+        return;
+    }
+
+    std::map<string, RegressResult>::iterator it = golden.find(key(r));
+    if (recording) {
+        std::cout << ((it == golden.end()) ? "  recorded" : "  re-recorded");
+    } else if (it == golden.end()) {
+        std::cout << "  FAIL: not in " << path << std::endl;
+        unknown++;
+        return;
+    } else {
+        const RegressResult& g = it->second;
+        std::ostringstream diff;
+        if (r.calls != g.calls) diff << " calls " << g.calls << "->" << r.calls;
+        if (r.hits != g.hits) diff << " hits " << g.hits << "->" << r.hits;
+        if (r.readHits != g.readHits) diff << " readHits " << g.readHits << "->" << r.readHits;
+        if (r.writeHits != g.writeHits) diff << " writeHits " << g.writeHits << "->" << r.writeHits;
+        if (r.evictedDirtyPage != g.evictedDirtyPage) diff << " evictedDirtyPage " << g.evictedDirtyPage << "->" << r.evictedDirtyPage;
+        if (r.hitBytes != g.hitBytes) diff << " hitBytes " << g.hitBytes << "->" << r.hitBytes;
+        if (!diff.str().empty()) {
+            std::cout << "  FAIL:" << diff.str() << std::endl;
+            mismatches++;
+            return;
+        }
+        std::cout << "  ok";
+    }
+
+    if (timed()) {
+        std::map<string, double>::iterator b = baseline.find(key(r));
+        if (b == baseline.end()) {
+            std::cout << ", baseline recorded";
+            baseline[key(r)] = r.throughput;
+            baselined++;
+        } else if (r.throughput < b->second * (1.0 - threshold)) {
+            std::cout << ", SLOWER: baseline " << (long long int)b->second << " requests/s (" << (long long int)(100.0 * (r.throughput / b->second - 1.0)) << "%)";
+            slower++;
+        } else {
+            std::cout << " (" << (r.throughput >= b->second ? "+" : "") << (long long int)(100.0 * (r.throughput / b->second - 1.0)) << "%)";
+        }
+    }
+    std::cout << std::endl;
+}
+
+// Only with -W: every run of this invocation gets its current counts, runs it did
+// not repeat (another -m or -s) are kept as they were
+bool RegressionCheck::writeGolden() {
+    std::map<string, RegressResult> all = golden;
+    for (size_t i = 0; i < results.size(); i++) all[key(results[i])] = results[i];
+    std::ofstream out(path.c_str());
+    if (!out.is_open()) {
+        std::cerr << "error: unable to write golden results to " << path << std::endl;
+        return false;
+    }
+    out << "# trace policy CacheSize calls hits readHits writeHits evictedDirtyPage hitBytes\n";
+    std::map<string, bool> done;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (done.count(key(results[i]))) continue;
+        write(out, all[key(results[i])]);
+        done[key(results[i])] = true;
+    }
+    for (std::map<string, RegressResult>::iterator it = all.begin(); it != all.end(); ++it) {
+        if (!done.count(it->first)) write(out, it->second);
+    }
+    std::cout << "Wrote " << results.size() << " golden results to " << path << std::endl;
+    return true;
+}
+
+// The baseline file is local to the machine: known runs keep their baseline, new ones
+// are added, and deleting the file re-baselines
+bool RegressionCheck::writeBaseline() {
+    std::ofstream out(baselinePath.c_str());
+    if (!out.is_open()) {
+        std::cerr << "error: unable to write throughput baselines to " << baselinePath << std::endl;
+        return false;
+    }
+    out << "# trace policy CacheSize <pages> requestsPerSecond <rate>\n";
+    for (std::map<string, double>::iterator it = baseline.begin(); it != baseline.end(); ++it) {
+        std::istringstream k(it->first);
+        string trace, policy;
+        int csize;
+        k >> trace >> policy >> csize;
+        out << trace << " " << policy << " CacheSize " << csize << " requestsPerSecond " << (long long int)it->second << "\n";
+    }
+    std::cout << "Added " << baselined << " throughput baselines to " << baselinePath << std::endl;
+    return true;
+}
+
+int RegressionCheck::finish() {
+    std::cout << std::endl << results.size() << " runs, " << mismatches << " result mismatches, " << unknown << " runs without golden results";
+    if (timed()) std::cout << ", " << slower << " throughput regressions beyond " << (long long int)(threshold * 100) << "%";
+    std::cout << std::endl;
+    // an unstable run is never recorded
+    if (recording && mismatches == 0 && !writeGolden()) return 1;
+    if (baselined > 0 && !writeBaseline()) return 1;
+    return (mismatches > 0 || unknown > 0 || slower > 0) ? 1 : 0;
+}
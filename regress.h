@@ -0,0 +1,67 @@
+/* regress.h - Regression check: every policy against stored golden results, and optionally local throughput baselines */
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include "partition.h"
+using namespace std;
+#ifndef _regress_H
+#define _regress_H
+
+#define REGRESS_CACHE_SIZE 1000  // pages, unless -s is given
+#define REGRESS_REPEATS 3        // timed measurements of each run, the fastest one is its throughput
+#define REGRESS_MIN_SECONDS 0.2  // a measurement replays the trace until this much processor time has passed
+#define REGRESS_THRESHOLD 20     // percent below the baseline throughput that is flagged
+#define REGRESS_SEED 42          // synthetic traces are generated from a fixed seed
+
+// Results of one policy over one trace; the counts must match the golden file
+// exactly. The throughput is only checked against a local baseline file, when one is
+// given: it depends on the machine, so it is never part of the golden file.
+struct RegressResult
+{
+    string trace;
+    string policy;
+    int csize;
+    long long int calls;    // pages referenced
+    long long int hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int hitBytes; // request bytes served from the cache
+    double throughput;      // requests per second, best of the measurements (0: not timed)
+};
+
+// Deterministic synthetic traces sized to the cache: "zipf" (single pages, skewed),
+// "loop" (a hot set under a sequential loop larger than the cache) and "ranges"
+// (multi-page requests at MSR-like offsets, half of them continuing a stream)
+const std::vector<string>& synthetic_traces();
+void synthetic_trace(const string& name, int csize, int pageSize, std::vector<TraceRequest>& out);
+
+class RegressionCheck
+{
+private:
+    string path;
+    string baselinePath; // empty: throughput is reported but not checked
+    double threshold;    // fraction of the baseline throughput that may be lost
+    bool recording;      // -W: this run writes the golden file instead of checking it
+    std::map<string, RegressResult> golden;
+    std::map<string, double> baseline; // requests per second by run
+    std::vector<RegressResult> results;
+    long long int mismatches;
+    long long int unknown; // runs the golden file does not know
+    long long int slower;
+    long long int baselined; // runs the baseline file does not know, added to it
+
+    static string key(const RegressResult&);
+    static void write(std::ostream&, const RegressResult&);
+    bool writeGolden();
+    bool writeBaseline();
+
+public:
+    RegressionCheck(const string& golden, const string& baseline, double percent, bool record);
+    bool load(); // false if a file is missing (golden, unless recording) or cannot be parsed
+    bool timed(); // throughput is checked, so every run has to be timed
+    void check(const RegressResult&, bool stable); // stable: every repeat gave the same counts
+    int finish(); // writes the files this run is allowed to, returns 1 on any regression
+};
+#endif
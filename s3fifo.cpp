@@ -0,0 +1,374 @@
+/* s3fifo.cpp - S3-FIFO Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "s3fifo.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+template <class Observer>
+S3FIFOCacheT<Observer>::S3FIFOCacheT(int n) : small(max(1, (int)(n * S3FIFO_SMALL_RATIO))), main(n) {
+    csize = n;
+    ghostHead = 0;
+    trimmed = 0;
+    sizes();
+
+    // Initialize statistics variables
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    promotions = 0;
+    ghostHits = 0;
+    migration = 0;
+    total_migration = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "S3-FIFO Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << ", Small: " << smallSize << ", Main: " << csize - smallSize << ", Ghost: " << ghostSize << std::endl;
+}
+
+template <class Observer>
+S3FIFOCacheT<Observer>::~S3FIFOCacheT() {
+    small.clear();
+    main.clear();
+    ghost.clear();
+    ghostPos.clear();
+}
+
+// ------------------------------------------------------------------
+// S3-FIFO Helper Functions
+// ------------------------------------------------------------------
+template <class Observer>
+uint32_t S3FIFOCacheT<Observer>::fingerprint(long long int x) {
+    // splitmix64 finaliser, the upper half is the fingerprint
+    unsigned long long z = (unsigned long long)x + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::sizes() {
+    smallSize = min(csize, max(1, (int)(csize * S3FIFO_SMALL_RATIO)));
+    int newGhostSize = (int)history_cap(max(1, csize - smallSize));
+
+    // Keep the newest fingerprints that still fit, oldest first
+    std::vector<uint32_t> kept;
+    ghosts(kept);
+    if ((int)kept.size() > newGhostSize) {
+        kept.erase(kept.begin(), kept.end() - newGhostSize);
+    }
+    ghostSize = newGhostSize;
+    ghost.assign(ghostSize, 0);
+    ghostPos.clear();
+    ghostHead = 0;
+    for (size_t i = 0; i < kept.size(); i++) {
+        ghost[ghostHead % ghostSize] = kept[i];
+        ghostPos[kept[i]] = ghostHead;
+        ghostHead++;
+    }
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::ghosts(std::vector<uint32_t>& out) {
+    // Fingerprints still remembered, oldest first
+    out.clear();
+    for (long long int i = max(0LL, ghostHead - (long long int)ghost.size()); i < ghostHead; i++) {
+        uint32_t f = ghost[i % ghost.size()];
+        std::unordered_map<uint32_t, long long int>::iterator it = ghostPos.find(f);
+        if (it != ghostPos.end() && it->second == i) out.push_back(f);
+    }
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::remember(long long int x) {
+    uint32_t f = fingerprint(x);
+    // The oldest fingerprint drops out unless it was seen again since
+    long long int slot = ghostHead % ghostSize;
+    if (ghostHead >= ghostSize) {
+        std::unordered_map<uint32_t, long long int>::iterator it = ghostPos.find(ghost[slot]);
+        if (it != ghostPos.end() && it->second == ghostHead - ghostSize) {
+            ghostPos.erase(it);
+            if (ghostSize < csize - smallSize) trimmed++;
+        }
+    }
+    ghost[slot] = f;
+    ghostPos[f] = ghostHead;
+    ghostHead++;
+}
+
+template <class Observer>
+bool S3FIFOCacheT<Observer>::recall(long long int x) {
+    // The ring slot is left behind, remember() skips it once it no longer matches
+    return ghostPos.erase(fingerprint(x)) > 0;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::evicted(long long int victim, bool dirty) {
+    if (dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(victim, dirty);
+    observer.evict(victim, dirty);
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::evict_main() {
+    // FIFO with reinsertion: a block visited since its last pass goes round again
+    KeyRing::Slot t;
+    while (main.pop(t)) {
+        if (t.visited) {
+            main.push(t.key, t.dirty != 0);
+            continue;
+        }
+        evicted(t.key, t.dirty != 0);
+        return;
+    }
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::evict_small() {
+    // Blocks hit while in the small FIFO move to the main FIFO; the first one
+    // that was not leaves the cache and is remembered by the ghost FIFO
+    KeyRing::Slot t;
+    while (small.pop(t)) {
+        if (t.visited) {
+            if (main.size() >= csize - smallSize) {
+                evict_main();
+            }
+            main.push(t.key, t.dirty != 0);
+            promotions++;
+            observer.promote(t.key);
+            continue;
+        }
+        remember(t.key);
+        evicted(t.key, t.dirty != 0);
+        return;
+    }
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::evict() {
+    if (small.size() > 0 && (small.size() >= smallSize || main.size() == 0)) {
+        evict_small();
+    } else {
+        evict_main();
+    }
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core S3-FIFO Logic)
+// ------------------------------------------------------------------
+template <class Observer>
+bool S3FIFOCacheT<Observer>::refer(long long int x, string rwtype) {
+    calls++;
+
+    KeyRing::Slot* s = small.find(x);
+    if (s == NULL) s = main.find(x);
+    if (s != NULL) {
+        // === HIT: only the visited bit (and dirty bit on a write) changes ===
+        hits++;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
+        s->visited = 1;
+        if (rwtype == "Write") s->dirty = 1;
+        return true;
+    }
+
+    // === MISS: a block the ghost FIFO remembers skips the small FIFO ===
+    observer.miss(x, rwtype);
+    // a cache of no pages admits nothing, and has nothing to evict for it
+    if (csize < 1) return false;
+    while (small.size() + main.size() >= csize) {
+        evict();
+    }
+    if (recall(x)) {
+        main.push(x, rwtype == "Write");
+        ghostHits++;
+        observer.ghostHit(x);
+    } else {
+        small.push(x, rwtype == "Write");
+    }
+    observer.insert(x);
+    migration++;
+    total_migration++;
+    return false;
+}
+
+template <class Observer>
+bool S3FIFOCacheT<Observer>::contains(long long int x) {
+    return small.find(x) != NULL || main.find(x) != NULL;
+}
+
+template <class Observer>
+bool S3FIFOCacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool S3FIFOCacheT<Observer>::remove(long long int x) {
+    // The block leaves without a ghost entry, it was not evicted by S3-FIFO
+    bool dirty = false;
+    if (!small.erase(x, dirty)) main.erase(x, dirty);
+    return dirty;
+}
+
+template <class Observer>
+long long int S3FIFOCacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::resize(int n) {
+    csize = n;
+    sizes();
+    while (small.size() + main.size() > max(csize, 0)) {
+        evict();
+    }
+}
+
+// ------------------------------------------------------------------
+// Snapshot: the small and main FIFOs oldest first with their visited bits,
+// then the ghost fingerprints oldest first
+// ------------------------------------------------------------------
+template <class Observer>
+bool S3FIFOCacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "S3FIFO", csize);
+    KeyRing* rings[2] = {&small, &main};
+    std::vector<KeyRing::Slot> keys;
+    for (int r = 0; r < 2; r++) {
+        rings[r]->keys(keys);
+        snap_put(out, (long long int)keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            snap_put_entry(out, keys[i].key, keys[i].dirty != 0);
+            snap_put(out, keys[i].visited);
+        }
+    }
+    std::vector<uint32_t> fps;
+    ghosts(fps);
+    snap_put(out, (long long int)fps.size());
+    for (size_t i = 0; i < fps.size(); i++) snap_put(out, fps[i]);
+    return (bool)out;
+}
+
+template <class Observer>
+bool S3FIFOCacheT<Observer>::load(std::istream& in) {
+    if (!snap_check(in, "S3FIFO", csize)) return false;
+    KeyRing* rings[2] = {&small, &main};
+    for (int r = 0; r < 2; r++) {
+        rings[r]->clear();
+        long long int n = 0;
+        if (!snap_get(in, n)) return false;
+        for (long long int i = 0; i < n; i++) {
+            long long int x;
+            bool dirty;
+            uint8_t visited;
+            if (!snap_get_entry(in, x, dirty) || !snap_get(in, visited)) return false;
+            rings[r]->push(x, dirty);
+            rings[r]->find(x)->visited = visited;
+        }
+    }
+    long long int n = 0;
+    if (!snap_get(in, n)) return false;
+    ghost.assign(ghostSize, 0);
+    ghostPos.clear();
+    ghostHead = 0;
+    for (long long int i = 0; i < n; i++) {
+        uint32_t f;
+        if (!snap_get(in, f)) return false;
+        // a snapshot taken without the budget keeps only its newest fingerprints
+        if (n - i > ghostSize) {
+            trimmed++;
+            continue;
+        }
+        ghost[ghostHead % ghostSize] = f;
+        ghostPos[f] = ghostHead;
+        ghostHead++;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int S3FIFOCacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // A miss in the middle of the range can promote or evict the pages before
+    // it, so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+
+// ------------------------------------------------------------------
+// Remaining Required Methods
+// ------------------------------------------------------------------
+template <class Observer>
+void S3FIFOCacheT<Observer>::display() {
+	std::cout << "S3-FIFO Cache displayed." << std::endl;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "small: " << small.size() << ", main: " << main.size() << ", ghost: " << ghostPos.size() << ", promotions: " << promotions << ", ghostHits: " << ghostHits << std::endl;
+
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result <<  "S3FIFO " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " promotions " << promotions << " ghostHits " << ghostHits << "\n" ;
+	}
+	result.close();
+	report_budget("S3FIFO", (long long int)ghostPos.size(), trimmed);
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::refresh(){
+	calls = 0;
+	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	promotions = 0;
+	ghostHits = 0;
+	trimmed = 0;
+	migration = 0;
+}
+
+template <class Observer>
+void S3FIFOCacheT<Observer>::summary() {
+	// print the number of total cache calls, hits, and data migration size
+}
+
+// The observers the simulator is built with (observer.h)
+template class S3FIFOCacheT<NullObserver>;
+template class S3FIFOCacheT<EventRecorder>;
@@ -0,0 +1,84 @@
+/* s3fifo.h - S3-FIFO Cache Policy: small, main and ghost FIFO queues */
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "fifo.h"
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+#include "budget.h"
+using namespace std;
+#ifndef _s3fifo_H
+#define _s3fifo_H
+
+#define S3FIFO_SMALL_RATIO 0.1 // share of the cache held by the small FIFO
+
+template <class Observer = NullObserver>
+class S3FIFOCacheT
+{
+private:
+    int csize;     // Maximum capacity of the cache
+    int smallSize; // target size of the small FIFO, the main FIFO holds the rest
+    int ghostSize; // fingerprints the ghost FIFO remembers (the main FIFO's size, or the metadata budget)
+    long long int trimmed; // fingerprints dropped early because of the budget
+
+    // New blocks enter the small FIFO; the ones hit there move to the main FIFO,
+    // the rest leave after one pass and are remembered by the ghost FIFO. The main
+    // FIFO reinserts blocks hit since their last pass (one visited bit each).
+    KeyRing small;
+    KeyRing main;
+
+    // Ghost FIFO: 32-bit fingerprints of the keys evicted from the small FIFO, in a
+    // ring, and the position of each fingerprint's newest entry. Two keys sharing
+    // a fingerprint are taken for each other, which is rare and harmless.
+    std::vector<uint32_t> ghost;
+    long long int ghostHead; // logical position of the next fingerprint
+    std::unordered_map<uint32_t, long long int> ghostPos;
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int promotions; // blocks moved from the small to the main FIFO
+    long long int ghostHits;  // misses that went straight to the main FIFO
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
+    long long int migration, total_migration;
+
+    // Helper functions for the S3-FIFO policy
+    static uint32_t fingerprint(long long int);
+    void sizes();
+    void ghosts(std::vector<uint32_t>&);
+    void remember(long long int);
+    bool recall(long long int);
+    void evict();
+    void evict_small();
+    void evict_main();
+    void evicted(long long int, bool);
+
+public:
+    S3FIFOCacheT(int);
+    ~S3FIFOCacheT();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, both FIFOs keep their shares
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+
+typedef S3FIFOCacheT<> S3FIFOCache;
+#endif
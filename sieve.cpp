@@ -0,0 +1,238 @@
+/* sieve.cpp - SIEVE Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include "sieve.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+template <class Observer>
+SIEVECacheT<Observer>::SIEVECacheT(int n) : queue(n) {
+    csize = n;
+
+    // Initialize statistics variables
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    handMoves = 0;
+    migration = 0;
+    total_migration = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "SIEVE Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << std::endl;
+}
+
+template <class Observer>
+SIEVECacheT<Observer>::~SIEVECacheT() {
+    queue.clear();
+}
+
+// ------------------------------------------------------------------
+// SIEVE Helper Functions
+// ------------------------------------------------------------------
+template <class Observer>
+void SIEVECacheT<Observer>::evict() {
+    // The hand walks from the oldest block toward the newest, clearing visited
+    // bits, and evicts the first block that was not visited since it last passed.
+    // Survivors keep their place, so new blocks are always the newest.
+    for (;;) {
+        KeyRing::Slot* s = queue.sweep();
+        if (s == NULL) return;
+        if (s->visited) {
+            s->visited = 0;
+            handMoves++;
+            queue.advance();
+            continue;
+        }
+        long long int victim = s->key;
+        bool dirty = false;
+        queue.erase(victim, dirty);
+        queue.advance();
+        if (dirty) {
+            evictedDirtyPage++;
+        }
+        if (sink) sink->evicted(victim, dirty);
+        observer.evict(victim, dirty);
+        return;
+    }
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core SIEVE Logic)
+// ------------------------------------------------------------------
+template <class Observer>
+bool SIEVECacheT<Observer>::refer(long long int x, string rwtype) {
+    calls++;
+
+    KeyRing::Slot* s = queue.find(x);
+    if (s != NULL) {
+        // === HIT: only the visited bit (and dirty bit on a write) changes ===
+        hits++;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+        observer.hit(x, rwtype);
+        s->visited = 1;
+        if (rwtype == "Write") s->dirty = 1;
+        return true;
+    }
+
+    // === MISS: the hand makes room, the block enters as the newest ===
+    observer.miss(x, rwtype);
+    if (queue.size() >= csize) {
+        evict();
+    }
+    queue.push(x, rwtype == "Write");
+    observer.insert(x);
+    migration++;
+    total_migration++;
+    return false;
+}
+
+template <class Observer>
+bool SIEVECacheT<Observer>::contains(long long int x) {
+    return queue.find(x) != NULL;
+}
+
+template <class Observer>
+bool SIEVECacheT<Observer>::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed like a miss, but it is not a demand reference
+    observer.installing(true);
+    refer(x, rwtype);
+    observer.installing(false);
+    calls--;
+    return true;
+}
+
+template <class Observer>
+bool SIEVECacheT<Observer>::remove(long long int x) {
+    bool dirty = false;
+    queue.erase(x, dirty);
+    return dirty;
+}
+
+template <class Observer>
+long long int SIEVECacheT<Observer>::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::setPageSize(int n) {
+    page_size = n;
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::resize(int n) {
+    csize = n;
+    while (queue.size() > csize) {
+        evict();
+    }
+}
+
+// ------------------------------------------------------------------
+// Snapshot: blocks oldest first with their visited bits, then the hand
+// ------------------------------------------------------------------
+template <class Observer>
+bool SIEVECacheT<Observer>::save(std::ostream& out) {
+    snap_header(out, "SIEVE", csize);
+    std::vector<KeyRing::Slot> keys;
+    queue.keys(keys);
+    snap_put(out, (long long int)keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        snap_put_entry(out, keys[i].key, keys[i].dirty != 0);
+        snap_put(out, keys[i].visited);
+    }
+    snap_put(out, queue.handIndex());
+    return (bool)out;
+}
+
+template <class Observer>
+bool SIEVECacheT<Observer>::load(std::istream& in) {
+    if (!snap_check(in, "SIEVE", csize)) return false;
+    queue.clear();
+    long long int n = 0;
+    if (!snap_get(in, n)) return false;
+    for (long long int i = 0; i < n; i++) {
+        long long int x;
+        bool dirty;
+        uint8_t visited;
+        if (!snap_get_entry(in, x, dirty) || !snap_get(in, visited)) return false;
+        queue.push(x, dirty);
+        queue.find(x)->visited = visited;
+    }
+    long long int hand = 0;
+    if (!snap_get(in, hand)) return false;
+    queue.setHandIndex(hand);
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+template <class Observer>
+int SIEVECacheT<Observer>::refer_range(long long int offset, int length, string rwtype) {
+    // A miss in the middle of the range moves the hand, so pages are resolved
+    // one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+
+// ------------------------------------------------------------------
+// Remaining Required Methods
+// ------------------------------------------------------------------
+template <class Observer>
+void SIEVECacheT<Observer>::display() {
+	std::cout << "SIEVE Cache displayed." << std::endl;
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+	std::cout<< "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " <<  writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+	std::cout<< "handMoves: " << handMoves << std::endl;
+
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) {
+		result <<  "SIEVE " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " handMoves " << handMoves << "\n" ;
+	}
+	result.close();
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::refresh(){
+	calls = 0;
+	hits = 0;
+	readHits = 0;
+	writeHits = 0;
+	evictedDirtyPage = 0;
+	handMoves = 0;
+	migration = 0;
+}
+
+template <class Observer>
+void SIEVECacheT<Observer>::summary() {
+	// print the number of total cache calls, hits, and data migration size
+}
+
+// The observers the simulator is built with (observer.h)
+template class SIEVECacheT<NullObserver>;
+template class SIEVECacheT<EventRecorder>;
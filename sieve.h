@@ -0,0 +1,56 @@
+/* sieve.h - SIEVE Cache Policy: a FIFO with one visited bit per block and a moving hand */
+#include <string>
+#include "fifo.h"
+#include "evictsink.h"
+#include "snapshot.h"
+#include "observer.h"
+using namespace std;
+#ifndef _sieve_H
+#define _sieve_H
+
+template <class Observer = NullObserver>
+class SIEVECacheT
+{
+private:
+    int csize; // Maximum capacity of the cache
+
+    // Blocks in insertion order; a hit sets the block's visited bit and nothing
+    // else, the hand clears bits on its way to the first unvisited block
+    KeyRing queue;
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int handMoves; // visited blocks the hand passed over
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    Observer observer; // sees every hit, miss, insert, eviction, ghost hit and promotion (observer.h)
+    int page_size; // keys are page-aligned byte addresses
+    long long int migration, total_migration;
+
+    void evict();
+
+public:
+    SIEVECacheT(int);
+    ~SIEVECacheT();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking moves the hand
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+
+typedef SIEVECacheT<> SIEVECache;
+#endif
@@ -0,0 +1,131 @@
+/* sketch.cpp - Count-min frequency sketch with doorkeeper Implementation */
+
+#include <algorithm>
+#include "sketch.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+CountMinSketch::CountMinSketch(int n) {
+    // One counter per expected key in each row, rounded up to a power of two
+    width = 16;
+    while (width < n) width <<= 1;
+    mask = width - 1;
+    table.assign((size_t)CMS_DEPTH * width / 2, 0);
+
+    // 8 doorkeeper bits per expected key keeps false positives low with two hashes
+    doorkeeper.assign(width / 8, 0);
+    doorkeeperMask = width * 8 - 1;
+
+    samples = 0;
+    sampleSize = 10LL * width;
+    resets = 0;
+}
+
+CountMinSketch::~CountMinSketch() {
+    table.clear();
+    doorkeeper.clear();
+}
+
+// ------------------------------------------------------------------
+// Hashing and counter access
+// ------------------------------------------------------------------
+uint64_t CountMinSketch::hash(long long int key, int seed) {
+    // splitmix64 finaliser, one seed per row
+    uint64_t z = (uint64_t)key + 0x9E3779B97F4A7C15ULL * (uint64_t)(seed + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int CountMinSketch::counter(int row, int index) const {
+    size_t slot = (size_t)row * width + index;
+    uint8_t byte = table[slot >> 1];
+    return (slot & 1) ? (byte >> 4) : (byte & 0x0F);
+}
+
+void CountMinSketch::setCounter(int row, int index, int value) {
+    size_t slot = (size_t)row * width + index;
+    uint8_t& byte = table[slot >> 1];
+    if (slot & 1) byte = (uint8_t)((byte & 0x0F) | (value << 4));
+    else byte = (uint8_t)((byte & 0xF0) | value);
+}
+
+bool CountMinSketch::doorkeeperContains(long long int key) const {
+    for (int i = 0; i < 2; i++) {
+        int bit = (int)(hash(key, CMS_DEPTH + i) & doorkeeperMask);
+        if (!(doorkeeper[bit >> 6] & (1ULL << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+void CountMinSketch::doorkeeperAdd(long long int key) {
+    for (int i = 0; i < 2; i++) {
+        int bit = (int)(hash(key, CMS_DEPTH + i) & doorkeeperMask);
+        doorkeeper[bit >> 6] |= (1ULL << (bit & 63));
+    }
+}
+
+// ------------------------------------------------------------------
+// Frequency estimation
+// ------------------------------------------------------------------
+void CountMinSketch::increment(long long int key) {
+    // One-hit wonders only ever reach the doorkeeper
+    if (!doorkeeperContains(key)) {
+        doorkeeperAdd(key);
+    } else {
+        for (int row = 0; row < CMS_DEPTH; row++) {
+            int index = (int)(hash(key, row) & mask);
+            int c = counter(row, index);
+            if (c < CMS_MAX_COUNT) setCounter(row, index, c + 1);
+        }
+    }
+
+    if (++samples >= sampleSize) age();
+}
+
+int CountMinSketch::estimate(long long int key) const {
+    int est = CMS_MAX_COUNT;
+    for (int row = 0; row < CMS_DEPTH; row++) {
+        est = min(est, counter(row, (int)(hash(key, row) & mask)));
+    }
+    return est + (doorkeeperContains(key) ? 1 : 0);
+}
+
+void CountMinSketch::age() {
+    // Halve every counter and forget the doorkeeper so old popularity decays
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = (uint8_t)((table[i] >> 1) & 0x77);
+    }
+    std::fill(doorkeeper.begin(), doorkeeper.end(), 0);
+    samples /= 2;
+    resets++;
+}
+
+long long int CountMinSketch::getResets() {
+    return resets;
+}
+
+long long int CountMinSketch::memoryBytes() {
+    return (long long int)table.size() + (long long int)doorkeeper.size() * 8;
+}
+
+// ------------------------------------------------------------------
+// Snapshot
+// ------------------------------------------------------------------
+void CountMinSketch::save(std::ostream& out) {
+    snap_put(out, width);
+    out.write((const char*)&table[0], table.size());
+    out.write((const char*)&doorkeeper[0], doorkeeper.size() * sizeof(uint64_t));
+    snap_put(out, samples);
+    snap_put(out, resets);
+}
+
+bool CountMinSketch::load(std::istream& in) {
+    int w = 0;
+    if (!snap_get(in, w) || w != width) return false;
+    in.read((char*)&table[0], table.size());
+    in.read((char*)&doorkeeper[0], doorkeeper.size() * sizeof(uint64_t));
+    return snap_get(in, samples) && snap_get(in, resets);
+}
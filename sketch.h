@@ -0,0 +1,45 @@
+/* sketch.h - Count-min frequency sketch with doorkeeper and periodic aging (TinyLFU) */
+#include <vector>
+#include <stdint.h>
+#include "snapshot.h"
+using namespace std;
+#ifndef _sketch_H
+#define _sketch_H
+
+#define CMS_DEPTH 4       // rows (independent hash functions)
+#define CMS_MAX_COUNT 15  // 4-bit saturating counters
+
+class CountMinSketch
+{
+private:
+    int width;      // counters per row (power of two)
+    int mask;
+    // CMS_DEPTH rows of 4-bit counters, two counters per byte
+    std::vector<uint8_t> table;
+    // Doorkeeper bloom filter: a key's first occurrence only sets its bits here
+    std::vector<uint64_t> doorkeeper;
+    int doorkeeperMask;
+
+    long long int samples;    // increments since the last aging
+    long long int sampleSize; // halve every counter after this many increments
+    long long int resets;
+
+    static uint64_t hash(long long int, int);
+    int counter(int row, int index) const;
+    void setCounter(int row, int index, int value);
+    bool doorkeeperContains(long long int) const;
+    void doorkeeperAdd(long long int);
+    void age();
+
+public:
+    CountMinSketch(int);
+    ~CountMinSketch();
+
+    void increment(long long int);
+    int estimate(long long int) const;
+    long long int getResets();
+    long long int memoryBytes();
+    void save(std::ostream&);
+    bool load(std::istream&);
+};
+#endif
@@ -0,0 +1,71 @@
+/* snapshot.h - Binary cache state snapshots (warm starts, cache persistence across reboots) */
+#include <string>
+#include <iostream>
+#include <stdint.h>
+using namespace std;
+#ifndef _snapshot_H
+#define _snapshot_H
+
+#define SNAPSHOT_MAGIC 0x50414E53 // "SNAP"
+#define SNAPSHOT_VERSION 1
+
+// Fields are written in native byte order and width: a snapshot is meant to be
+// restored by the same simulator build that took it.
+template <class T>
+inline void snap_put(std::ostream& out, const T& value) {
+    out.write((const char*)&value, sizeof(T));
+}
+
+template <class T>
+inline bool snap_get(std::istream& in, T& value) {
+    in.read((char*)&value, sizeof(T));
+    return (bool)in;
+}
+
+// One cached key and its dirty bit
+inline void snap_put_entry(std::ostream& out, long long int key, bool dirty) {
+    snap_put(out, key);
+    snap_put(out, (uint8_t)(dirty ? 1 : 0));
+}
+
+inline bool snap_get_entry(std::istream& in, long long int& key, bool& dirty) {
+    uint8_t d = 0;
+    if (!snap_get(in, key) || !snap_get(in, d)) return false;
+    dirty = (d != 0);
+    return true;
+}
+
+// Each policy's state starts with a header naming the policy and its capacity;
+// state is only restored into the same policy and size it was taken from
+inline void snap_header(std::ostream& out, const string& policy, long long int csize) {
+    uint32_t magic = SNAPSHOT_MAGIC;
+    uint32_t version = SNAPSHOT_VERSION;
+    uint8_t length = (uint8_t)policy.size();
+    snap_put(out, magic);
+    snap_put(out, version);
+    snap_put(out, length);
+    out.write(policy.data(), length);
+    snap_put(out, csize);
+}
+
+inline bool snap_check(std::istream& in, const string& policy, long long int csize) {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint8_t length = 0;
+    if (!snap_get(in, magic) || !snap_get(in, version) || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+        std::cerr << "error: not a cache snapshot, or written by another version" << std::endl;
+        return false;
+    }
+    string name;
+    long long int size = 0;
+    if (!snap_get(in, length)) return false;
+    name.resize(length);
+    if (length > 0) in.read(&name[0], length);
+    if (!snap_get(in, size)) return false;
+    if (name != policy || size != csize) {
+        std::cerr << "error: snapshot holds " << name << " with cache size " << size << ", cannot restore it into " << policy << " with cache size " << csize << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,113 @@
+/* tenant.cpp - Multi-tenant cache partitioning Implementation */
+
+#include <iostream>
+#include <algorithm>
+#include <stdint.h>
+#include "tenant.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Tenant directory
+// ------------------------------------------------------------------
+int TenantDirectory::id(const string& tenant) {
+    std::unordered_map<string, int>::iterator it = ids.find(tenant);
+    if (it != ids.end()) return it->second;
+    int n = (int)names.size();
+    ids[tenant] = n;
+    names.push_back(tenant);
+    return n;
+}
+
+int TenantDirectory::size() {
+    return (int)names.size();
+}
+
+const string& TenantDirectory::name(int i) {
+    return names[i];
+}
+
+void TenantDirectory::operator()(double /*time*/, long long int /*offset*/, int /*size*/, string /*rwtype*/, const string& tenant) {
+    id(tenant);
+}
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+UtilityMonitor::UtilityMonitor(int csize) {
+    sets = max(1, csize / TENANT_UNITS);
+    stride = max(1, sets / UMON_SAMPLED_SETS);
+    tags.resize((sets + stride - 1) / stride);
+    wayHits.assign(TENANT_UNITS, 0);
+}
+
+UtilityMonitor::~UtilityMonitor() {
+    tags.clear();
+    wayHits.clear();
+}
+
+// ------------------------------------------------------------------
+// Shadow directory
+// ------------------------------------------------------------------
+void UtilityMonitor::access(long long int key) {
+    // splitmix64 finaliser spreads page addresses over the sets
+    uint64_t z = (uint64_t)key + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= (z >> 31);
+    int set = (int)(z % (uint64_t)sets);
+    if (set % stride != 0) return;
+
+    std::vector<long long int>& ways = tags[set / stride];
+    std::vector<long long int>::iterator it = std::find(ways.begin(), ways.end(), key);
+    if (it != ways.end()) {
+        wayHits[it - ways.begin()]++;
+        ways.erase(it);
+    } else if ((int)ways.size() == TENANT_UNITS) {
+        ways.pop_back();
+    }
+    ways.insert(ways.begin(), key);
+}
+
+long long int UtilityMonitor::hits(int units) const {
+    long long int total = 0;
+    for (int i = 0; i < units && i < TENANT_UNITS; i++) total += wayHits[i];
+    return total;
+}
+
+void UtilityMonitor::age() {
+    for (int i = 0; i < TENANT_UNITS; i++) wayHits[i] /= 2;
+}
+
+// ------------------------------------------------------------------
+// Allocation
+// ------------------------------------------------------------------
+std::vector<int> lookahead_partition(const std::vector<UtilityMonitor*>& monitors, int units) {
+    int n = (int)monitors.size();
+    std::vector<int> alloc(n, 1);
+    int balance = units - n;
+    while (balance > 0) {
+        // each tenant's best marginal utility: hits gained per unit over any extension
+        int winner = 0;
+        int winnerUnits = 1;
+        double best = -1;
+        for (int t = 0; t < n; t++) {
+            long long int base = monitors[t]->hits(alloc[t]);
+            for (int k = 1; k <= balance; k++) {
+                double mu = (double)(monitors[t]->hits(alloc[t] + k) - base) / k;
+                if (mu > best) {
+                    best = mu;
+                    winner = t;
+                    winnerUnits = k;
+                }
+            }
+        }
+        if (best <= 0) {
+            // nobody gains from more cache: spread the rest evenly
+            for (int t = 0; balance > 0; t = (t + 1) % n, balance--) alloc[t]++;
+            break;
+        }
+        alloc[winner] += winnerUnits;
+        balance -= winnerUnits;
+    }
+    return alloc;
+}
@@ -0,0 +1,59 @@
+/* tenant.h - Multi-tenant cache partitioning: tenant ids and utility monitors */
+#include <string>
+#include <vector>
+#include <unordered_map>
+using namespace std;
+#ifndef _tenant_H
+#define _tenant_H
+
+#define TENANT_UNITS 64      // allocation granularity: the cache is split into this many equal units
+#define UMON_SAMPLED_SETS 32 // shadow sets monitored per tenant
+
+// How the tenants of a trace share the cache
+enum TenantMode {
+    TENANT_SHARED,  // one cache, every tenant competes for all of it
+    TENANT_STATIC,  // equal fixed partitions
+    TENANT_DYNAMIC  // partitions resized every epoch from the tenants' miss curves
+};
+
+// Dense ids for the tenants of a trace (MSR device_disk), in order of first appearance
+class TenantDirectory
+{
+private:
+    std::unordered_map<string, int> ids;
+    std::vector<string> names;
+
+public:
+    int id(const string&);
+    int size();
+    const string& name(int);
+
+    // First pass over the trace: registers every tenant
+    void operator()(double time, long long int offset, int size, string rwtype, const string& tenant);
+};
+
+// Utility monitor (UMON) of one tenant: a shadow LRU tag directory shaped like the
+// whole cache split into TENANT_UNITS ways, of which only a sample of the sets is
+// kept. Hits are counted per LRU position, so hits(u) estimates the tenant's hits
+// if it had u units of the cache to itself.
+class UtilityMonitor
+{
+private:
+    int sets;   // sets of the full-size shadow directory
+    int stride; // every stride-th set is sampled
+    std::vector<std::vector<long long int> > tags; // sampled sets, MRU first
+    std::vector<long long int> wayHits;            // hits at each LRU position
+
+public:
+    UtilityMonitor(int);
+    ~UtilityMonitor();
+
+    void access(long long int);
+    long long int hits(int units) const;
+    void age(); // halve the counters, so the next epoch outweighs the history
+};
+
+// UCP lookahead allocation: units per tenant that maximise the estimated total
+// hits, at least one unit each
+std::vector<int> lookahead_partition(const std::vector<UtilityMonitor*>&, int units);
+#endif
@@ -0,0 +1,200 @@
+/* cache_test.cpp - Checks of the key-value cache (cache.h) over each page policy
+
+Build and run from the repository root:
+g++ -std=c++11 -pthread -I. -o cache_test test/cache_test.cpp lru.cpp lfu.cpp lirs.cpp arc.cpp cacheus.cpp arena.cpp && ./cache_test
+*/
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "cache.h"
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << policyName << ": check failed: " #cond << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+static const char* policyName = "";
+
+// Every key hashes to the same value
+struct CollidingHash {
+    size_t operator()(const string&) const { return 7; }
+};
+
+// Neither copyable nor movable: only emplace() can build it
+struct Pinned {
+    std::mutex lock;
+    int n;
+    Pinned(int v) : n(v) {}
+};
+
+// Throws when built from a negative number
+struct Picky {
+    int n;
+    Picky(int v) : n(v) {
+        if (v < 0) throw std::invalid_argument("negative");
+    }
+};
+
+template <class Policy>
+void test_get_put_erase() {
+    Cache<string, int, std::hash<string>, Policy> c(4);
+    CHECK(c.get("a") == NULL);
+    CHECK(c.put("a", 1));
+    CHECK(c.contains("a"));
+    CHECK(c.get("a") && *c.get("a") == 1);
+    CHECK(c.put("a", 2)); // replaces
+    CHECK(c.size() == 1 && *c.get("a") == 2);
+    CHECK(c.erase("a"));
+    CHECK(!c.erase("a"));
+    CHECK(!c.contains("a") && c.get("a") == NULL);
+    CHECK(c.size() == 0);
+    CHECK(c.hitCount() == 3 && c.missCount() == 2);
+}
+
+// Never more than capacity values, every victim goes through the callback exactly once
+template <class Policy>
+void test_eviction_callback() {
+    Cache<string, int, std::hash<string>, Policy> c(8);
+    std::vector<string> victims;
+    c.setEvictionCallback([&](const string& k, int& v) {
+        if (k != "k" + std::to_string(v)) failures++;
+        victims.push_back(k);
+    });
+    unsigned s = 1;
+    long long int puts = 0;
+    for (int i = 0; i < 5000; i++) {
+        s = s * 1103515245 + 12345;
+        int k = (s >> 16) % 32;
+        string key = "k" + std::to_string(k);
+        int* v = c.get(key);
+        if (v) {
+            CHECK(*v == k);
+        } else if (c.put(key, k)) {
+            puts++;
+        }
+        CHECK(c.size() <= 8);
+    }
+    CHECK(c.evictionCount() == (long long int)victims.size());
+    CHECK(puts - (long long int)victims.size() == (long long int)c.size());
+}
+
+// unique_ptr values: put moves them in, the callback may move them out
+template <class Policy>
+void test_move_only() {
+    Cache<int, std::unique_ptr<int>, std::hash<int>, Policy> c(2);
+    std::vector<std::unique_ptr<int> > spilled;
+    c.setEvictionCallback([&](const int& k, std::unique_ptr<int>& v) {
+        if (!v || *v != k * 10) failures++;
+        spilled.push_back(std::move(v));
+    });
+    for (int k = 0; k < 10; k++) {
+        std::unique_ptr<int> v(new int(k * 10));
+        CHECK(c.put(k, std::move(v)));
+        CHECK(c.get(k) && **c.get(k) == k * 10);
+    }
+    CHECK(c.size() == 2);
+    CHECK(spilled.size() == 8);
+    CHECK(c.emplace(42, new int(420)));
+    CHECK(c.get(42) && **c.get(42) == 420);
+}
+
+// emplace() builds and rebuilds the value where it lives
+template <class Policy>
+void test_in_place() {
+    Cache<int, Pinned, std::hash<int>, Policy> c(2);
+    CHECK(c.emplace(1, 5));
+    Pinned* p = c.get(1);
+    CHECK(p && p->n == 5);
+    CHECK(c.emplace(1, 6));
+    CHECK(c.get(1) == p && p->n == 6);
+}
+
+// A throwing constructor leaves no trace: no value, no slot in the policy
+template <class Policy>
+void test_throwing_value() {
+    Cache<int, Picky, std::hash<int>, Policy> c(2);
+    CHECK(c.emplace(1, 1));
+    CHECK(c.emplace(2, 2));
+    bool thrown = false;
+    try {
+        c.emplace(3, -1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(!c.contains(3));
+    CHECK(c.size() == 2 && c.evictionCount() == 0); // nobody was evicted for it
+    thrown = false;
+    try {
+        c.emplace(1, -1); // replacing: the old value is gone, so is the key
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(!c.contains(1) && c.size() == 1);
+    CHECK(c.emplace(3, 3) && c.emplace(4, 4));
+    CHECK(c.size() == 2);
+}
+
+// Keys whose hashes collide are separate entries
+template <class Policy>
+void test_colliding_hash() {
+    Cache<string, int, CollidingHash, Policy> c(4);
+    CHECK(c.put("x", 1) && c.put("y", 2) && c.put("z", 3));
+    CHECK(c.size() == 3 && c.evictionCount() == 0);
+    CHECK(c.get("x") && *c.get("x") == 1);
+    CHECK(c.get("y") && *c.get("y") == 2);
+    CHECK(c.get("z") && *c.get("z") == 3);
+    CHECK(c.erase("y") && !c.contains("y") && c.contains("x") && c.contains("z"));
+}
+
+// A miss followed by a put is the policy's own miss: the cache hits exactly where the
+// bare policy replaying the same keys does, ghost hits included
+template <class Policy>
+void test_same_as_policy() {
+    Cache<long long int, char, std::hash<long long int>, Policy> c(64);
+    Policy p(64, false);
+    unsigned s = 7;
+    long long int policyHits = 0;
+    for (int i = 0; i < 50000; i++) {
+        s = s * 1103515245 + 12345;
+        // a hot set under a scan, so the history matters
+        long long int k = (i % 3 == 0) ? (s >> 16) % 48 : 1000 + i % 200;
+        policyHits += p.refer(k, "Read");
+        if (!c.get(k)) c.put(k, 0);
+    }
+    CHECK(c.hitCount() == policyHits);
+}
+
+template <class Policy>
+void test_policy(const char* name) {
+    policyName = name;
+    int before = failures;
+    test_get_put_erase<Policy>();
+    test_eviction_callback<Policy>();
+    test_move_only<Policy>();
+    test_in_place<Policy>();
+    test_throwing_value<Policy>();
+    test_colliding_hash<Policy>();
+    test_same_as_policy<Policy>();
+    std::cout << name << ": " << (failures == before ? "ok" : "FAILED") << std::endl;
+}
+
+int main() {
+    test_policy<LRUCache>("LRU");
+    test_policy<LFUCache>("LFU");
+    test_policy<LIRSCache>("LIRS");
+    test_policy<ARCCache>("ARC");
+    test_policy<CACHEUSCache>("CACHEUS");
+    return failures > 0 ? 1 : 0;
+}
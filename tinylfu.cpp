@@ -0,0 +1,250 @@
+/* tinylfu.cpp - W-TinyLFU (Window TinyLFU) Cache Policy Implementation */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "tinylfu.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+// The window takes 1% of the cache and the protected segment 80% of the
+// main region, the split recommended for W-TinyLFU. The segments reuse
+// LRUCache and are never filled past their share, so they never evict on
+// their own: every eviction decision is made here.
+WTinyLFUCache::WTinyLFUCache(int n)
+    : window(max(1, n / 100), false),
+      probation(max(0, n - max(1, n / 100)), false),
+      protect(max(0, (int)((n - max(1, n / 100)) * 0.8)), false),
+      sketch(n) {
+    csize = n;
+    window_size = max(1, csize / 100);
+    protected_size = max(0, (int)((csize - window_size) * 0.8));
+
+    hits = 0;
+    total_hits = 0;
+    calls = 0;
+    total_calls = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    admitted = 0;
+    rejected = 0;
+    sink = NULL;
+    page_size = PAGE_SIZE;
+
+    std::cout << "W-TinyLFU Algorithm is used" << std::endl;
+    std::cout << "Cache size: " << csize << ", Window: " << window_size << ", Protected: " << protected_size << ", Sketch bytes: " << sketch.memoryBytes() << std::endl;
+}
+
+WTinyLFUCache::~WTinyLFUCache() {
+}
+
+// ------------------------------------------------------------------
+// W-TinyLFU Helper Functions
+// ------------------------------------------------------------------
+void WTinyLFUCache::evict(long long int victim, bool dirty) {
+    if (dirty) {
+        evictedDirtyPage++;
+    }
+    if (sink) sink->evicted(victim, dirty);
+}
+
+void WTinyLFUCache::admit(long long int candidate, bool dirty) {
+    // A window victim competes with the main region's victim for a slot
+    int main_size = csize - window_size;
+    if (main_size <= 0) {
+        evict(candidate, dirty);
+        return;
+    }
+    if (probation.size() + protect.size() < main_size) {
+        probation.refer(candidate, dirty ? "Write" : "Read");
+        return;
+    }
+
+    LRUCache& segment = (probation.size() > 0) ? probation : protect;
+    long long int victim = segment.lru();
+    // TinyLFU admission: keep whichever key the sketch says is more popular
+    if (sketch.estimate(candidate) > sketch.estimate(victim)) {
+        evict(victim, segment.remove(victim));
+        probation.refer(candidate, dirty ? "Write" : "Read");
+        admitted++;
+    } else {
+        evict(candidate, dirty);
+        rejected++;
+    }
+}
+
+void WTinyLFUCache::insert(long long int x, string rwtype) {
+    // New keys enter the window, whose LRU victim then asks for admission
+    if (window.size() >= window_size) {
+        long long int candidate = window.lru();
+        bool dirty = window.remove(candidate);
+        admit(candidate, dirty);
+    }
+    window.refer(x, rwtype);
+}
+
+// ------------------------------------------------------------------
+// Refer Method (Core W-TinyLFU Logic)
+// ------------------------------------------------------------------
+bool WTinyLFUCache::refer(long long int x, string rwtype) {
+    calls++;
+    sketch.increment(x);
+
+    bool hit = true;
+    if (window.contains(x)) {
+        window.refer(x, rwtype);
+    } else if (protect.contains(x)) {
+        protect.refer(x, rwtype);
+    } else if (probation.contains(x)) {
+        // A second hit in the main region promotes to protected,
+        // demoting the protected LRU key back to probation if needed
+        bool dirty = probation.remove(x) || rwtype == "Write";
+        if (protect.size() >= protected_size && protect.size() > 0) {
+            long long int demoted = protect.lru();
+            bool demotedDirty = protect.remove(demoted);
+            probation.refer(demoted, demotedDirty ? "Write" : "Read");
+        }
+        if (protected_size > 0) protect.refer(x, dirty ? "Write" : "Read");
+        else probation.refer(x, dirty ? "Write" : "Read");
+    } else {
+        hit = false;
+        insert(x, rwtype);
+    }
+
+    if (hit) {
+        hits++;
+        (rwtype == "Read") ? readHits++ : writeHits++;
+    }
+    return hit;
+}
+
+bool WTinyLFUCache::contains(long long int x) {
+    return window.contains(x) || probation.contains(x) || protect.contains(x);
+}
+
+bool WTinyLFUCache::install(long long int x, string rwtype) {
+    if (contains(x)) return false;
+    // Installed through the window like a miss, without counting toward its frequency
+    insert(x, rwtype);
+    return true;
+}
+
+bool WTinyLFUCache::remove(long long int x) {
+    // The sketch keeps the key's frequency, only residency is dropped
+    if (window.contains(x)) return window.remove(x);
+    if (probation.contains(x)) return probation.remove(x);
+    return protect.remove(x);
+}
+
+long long int WTinyLFUCache::getEvictedDirtyPage() {
+    return evictedDirtyPage;
+}
+
+void WTinyLFUCache::setEvictionSink(EvictionSink* s) {
+    sink = s;
+}
+
+void WTinyLFUCache::setPageSize(int n) {
+    page_size = n;
+}
+
+void WTinyLFUCache::resize(int n) {
+    csize = n;
+    window_size = max(1, csize / 100);
+    protected_size = max(0, (int)((csize - window_size) * 0.8));
+    int main_size = max(0, csize - window_size);
+    // the segments may hold more than their new share until it is evicted here,
+    // so they are never asked to evict on their own
+    window.resize(max(window.size(), window_size));
+    probation.resize(max(probation.size(), main_size));
+    protect.resize(max(protect.size(), protected_size));
+
+    // the main region gives up its LRU keys, probation first
+    while (probation.size() + protect.size() > main_size) {
+        LRUCache& segment = (probation.size() > 0) ? probation : protect;
+        long long int victim = segment.lru();
+        evict(victim, segment.remove(victim));
+    }
+    while (protect.size() > protected_size) {
+        long long int demoted = protect.lru();
+        bool demotedDirty = protect.remove(demoted);
+        probation.refer(demoted, demotedDirty ? "Write" : "Read");
+    }
+    // window victims ask for admission as usual
+    while (window.size() > window_size) {
+        long long int candidate = window.lru();
+        bool dirty = window.remove(candidate);
+        admit(candidate, dirty);
+    }
+
+    window.resize(window_size);
+    probation.resize(main_size);
+    protect.resize(protected_size);
+}
+
+// ------------------------------------------------------------------
+// Snapshot: the three LRU segments, then the frequency sketch
+// ------------------------------------------------------------------
+bool WTinyLFUCache::save(std::ostream& out) {
+    snap_header(out, "TinyLFU", csize);
+    window.save(out);
+    probation.save(out);
+    protect.save(out);
+    sketch.save(out);
+    return (bool)out;
+}
+
+bool WTinyLFUCache::load(std::istream& in) {
+    return snap_check(in, "TinyLFU", csize) && window.load(in) && probation.load(in) && protect.load(in) && sketch.load(in);
+}
+
+// ------------------------------------------------------------------
+// Range Refer: every page (page_size bytes) touched by [offset, offset+length)
+// ------------------------------------------------------------------
+int WTinyLFUCache::refer_range(long long int offset, int length, string rwtype) {
+    // Admission of an earlier page of the run can evict a later one,
+    // so pages are resolved one at a time in address order
+    int hitPages = 0;
+    long long int first = offset - offset % page_size;
+    for (long long int x = first; x < offset + length; x += page_size) {
+        if (refer(x, rwtype)) hitPages++;
+    }
+    return hitPages;
+}
+
+// ------------------------------------------------------------------
+// Remaining Required Methods (Statistical Reporting)
+// ------------------------------------------------------------------
+void WTinyLFUCache::display() {
+    std::cout << "W-TinyLFU Cache displayed." << std::endl;
+}
+
+void WTinyLFUCache::cachehits() {
+    float hitRatio = (calls > 0) ? (float)hits / calls : 0.0;
+
+    std::cout << "calls: " << calls << ", hits: " << hits << ", readHits: " << readHits << ", writeHits: " << writeHits << ", evictedDirtyPage: " << evictedDirtyPage << std::endl;
+    std::cout << "admitted: " << admitted << ", rejected: " << rejected << ", sketchResets: " << sketch.getResets() << ", sketchBytes: " << sketch.memoryBytes() << std::endl;
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << "TinyLFU " << "CacheSize " << csize << " calls " << calls << " hits " << hits << " hitRatio " << hitRatio << " readHits " << readHits << " readHitRatio " << ((calls > 0) ? (float)readHits/calls : 0.0) << " writeHits " << writeHits << " writeHitRatio " << ((calls > 0) ? (float)writeHits/calls : 0.0) << " evictedDirtyPage " << evictedDirtyPage << " admitted " << admitted << " rejected " << rejected << " sketchBytes " << sketch.memoryBytes() << "\n";
+    }
+    result.close();
+}
+
+void WTinyLFUCache::refresh() {
+    calls = 0;
+    hits = 0;
+    readHits = 0;
+    writeHits = 0;
+    evictedDirtyPage = 0;
+    admitted = 0;
+    rejected = 0;
+}
+
+void WTinyLFUCache::summary() {
+    // print the number of total cache calls, hits, and data migration size
+}
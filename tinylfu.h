@@ -0,0 +1,64 @@
+/* tinylfu.h - W-TinyLFU (Window TinyLFU) Cache Policy */
+#include <string>
+#include <list>
+#include <unordered_map>
+#include "lru.h"
+#include "sketch.h"
+#include "evictsink.h"
+#include "snapshot.h"
+using namespace std;
+#ifndef _tinylfu_H
+#define _tinylfu_H
+
+class WTinyLFUCache
+{
+private:
+    int csize;          // Maximum capacity of the cache (C)
+    int window_size;    // Admission window, 1% of C
+    int protected_size; // Protected segment, 80% of the main region
+
+    // Window: new keys always enter here (an LRU)
+    LRUCache window;
+    // Main region: an SLRU of a probation and a protected LRU segment
+    LRUCache probation;
+    LRUCache protect;
+
+    // Frequency history, kept for evicted keys too, in a few bytes per key
+    CountMinSketch sketch;
+
+    // Statistics (Similar to LRU/LFU)
+    long long int calls, total_calls;
+    long long int hits, total_hits;
+    long long int readHits;
+    long long int writeHits;
+    long long int evictedDirtyPage;
+    long long int admitted;   // window victims that won admission into the main region
+    long long int rejected;   // window victims dropped by the admission filter
+    EvictionSink* sink; // optional receiver of every victim (write-back buffer, lower tier)
+    int page_size; // keys are page-aligned byte addresses
+
+    // Helper functions for the W-TinyLFU policy
+    void insert(long long int, string);
+    void admit(long long int, bool);
+    void evict(long long int, bool);
+
+public:
+    WTinyLFUCache(int);
+    ~WTinyLFUCache();
+    bool refer(long long int, string); // returns true on a cache hit
+    int refer_range(long long int, int, string); // whole request, returns the number of pages that hit
+    bool contains(long long int); // resident check, not counted as a reference
+    bool install(long long int, string); // place a page (prefetch, tier migration) without counting a reference
+    bool remove(long long int); // drop a resident key without counting an eviction, returns true if it was dirty
+    long long int getEvictedDirtyPage();
+    void setEvictionSink(EvictionSink*);
+    void setPageSize(int);
+    void resize(int); // change the capacity, shrinking evicts the main region, then the window through admission
+    bool save(std::ostream&); // write the full cache state as a binary snapshot
+    bool load(std::istream&); // restore a snapshot taken from the same policy and size
+    void display();
+    void cachehits();
+    void refresh();
+    void summary();
+};
+#endif
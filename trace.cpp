@@ -0,0 +1,211 @@
+/* trace.cpp - Trace reader Implementation */
+
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+using namespace std;
+
+#define TRACE_MAX_FAST_DIGITS 15 // a decimal mantissa this short converts exactly through a double
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+TraceReader::TraceReader() {
+    data = end = pos = NULL;
+    length = 0;
+    mapped = false;
+    skipped = 0;
+}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+bool TraceReader::open(const char* filename) {
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = (size_t)st.st_size;
+    if (length > 0) {
+        void* p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, length, MADV_SEQUENTIAL);
+            data = (const char*)p;
+            mapped = true;
+        } else {
+            // not mappable (a pipe, some network file systems): read it whole
+            buffer.resize(length);
+            size_t got = 0;
+            while (got < length) {
+                ssize_t n = read(fd, &buffer[got], length - got);
+                if (n <= 0) break;
+                got += n;
+            }
+            length = got;
+            data = buffer.empty() ? NULL : &buffer[0];
+        }
+    }
+    ::close(fd);
+    pos = data;
+    end = data + length;
+    return true;
+}
+
+void TraceReader::close() {
+    if (mapped) munmap((void*)data, length);
+    mapped = false;
+    buffer.clear();
+    data = end = pos = NULL;
+    length = 0;
+}
+
+long long int TraceReader::bytes() const {
+    return (long long int)length;
+}
+
+long long int TraceReader::getSkipped() const {
+    return skipped;
+}
+
+// ------------------------------------------------------------------
+// Field Parsers: each one advances pos past what it consumed
+// ------------------------------------------------------------------
+void TraceReader::skip_line() {
+    const char* nl = (const char*)memchr(pos, '\n', end - pos);
+    pos = nl ? nl + 1 : end;
+}
+
+void TraceReader::skip_blanks() {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n')) pos++;
+}
+
+void TraceReader::skip_spaces() {
+    while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+}
+
+bool TraceReader::parse_int(long long int& value) {
+    while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+    bool negative = (pos < end && *pos == '-');
+    if (negative) pos++;
+    const char* first = pos;
+    unsigned long long v = 0;
+    while (pos < end && (unsigned)(*pos - '0') < 10) {
+        v = v * 10 + (*pos - '0');
+        pos++;
+    }
+    if (pos == first) return false;
+    value = negative ? -(long long int)v : (long long int)v;
+    return true;
+}
+
+bool TraceReader::parse_double(double& value) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+    const char* first = pos;
+    bool negative = (pos < end && *pos == '-');
+    if (negative) pos++;
+    unsigned long long mantissa = 0;
+    int digits = 0, fraction = 0;
+    while (pos < end && (unsigned)(*pos - '0') < 10) {
+        mantissa = mantissa * 10 + (*pos++ - '0');
+        digits++;
+    }
+    if (pos < end && *pos == '.') {
+        pos++;
+        while (pos < end && (unsigned)(*pos - '0') < 10) {
+            mantissa = mantissa * 10 + (*pos++ - '0');
+            digits++;
+            fraction++;
+        }
+    }
+    if (digits == 0) {
+        pos = first;
+        return false;
+    }
+    if (digits <= TRACE_MAX_FAST_DIGITS && (pos == end || (*pos != 'e' && *pos != 'E'))) {
+        // exact mantissa divided by an exact power of ten: correctly rounded, like strtod
+        value = (double)mantissa / pow10[fraction];
+        if (negative) value = -value;
+        return true;
+    }
+    // long mantissas and exponents go through strtod on a terminated copy
+    while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n' && *pos != ',') pos++;
+    string token(first, pos - first);
+    char* stop = NULL;
+    value = strtod(token.c_str(), &stop);
+    return stop != token.c_str();
+}
+
+bool TraceReader::separator(char c) {
+    if (pos == end || *pos != c) return false;
+    pos++;
+    return true;
+}
+
+bool TraceReader::parse_field(const char*& field, int& fieldLength) {
+    // up to the next comma, which is consumed
+    field = pos;
+    while (pos < end && *pos != ',' && *pos != '\n') pos++;
+    if (pos == end || *pos != ',') return false;
+    fieldLength = (int)(pos - field);
+    pos++;
+    return true;
+}
+
+// ------------------------------------------------------------------
+// Records
+// ------------------------------------------------------------------
+bool TraceReader::nextMSR(MSRRecord& r) {
+    while (pos < end) {
+        const char* line = pos;
+        const char* type;
+        int typeLength;
+        long long int disk = 0, size = 0;
+        if (parse_int(r.timestamp) && separator(',')
+            && parse_field(r.host, r.hostLength)
+            && parse_int(disk) && separator(',')
+            && parse_field(type, typeLength)
+            && parse_int(r.offset) && separator(',')
+            && parse_int(size)) {
+            r.disk = (int)disk;
+            r.write = (typeLength == 5 && memcmp(type, "Write", 5) == 0);
+            r.size = (int)size;
+            skip_line(); // ResponseTime is not used
+            return true;
+        }
+        // a header or a truncated row; blank lines and rows of empty fields
+        // (spreadsheet padding, ",,,,,,") do not count
+        pos = line;
+        skip_line();
+        const char* p = line;
+        while (p < pos && (*p == ',' || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+        if (p < pos) skipped++;
+    }
+    return false;
+}
+
+bool TraceReader::nextKey(KeyRecord& r) {
+    while (true) {
+        skip_blanks();
+        if (pos >= end) return false;
+        long long int key = 0;
+        // the three fields are on one line: a row cut short does not borrow from the next
+        if (parse_double(r.time) && parse_int(key) && (skip_spaces(), pos < end && *pos != '\r' && *pos != '\n')) {
+            r.key = key;
+            r.pattern = *pos;
+            while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r' && *pos != '\n') pos++;
+            return true;
+        }
+        skipped++;
+        skip_line();
+    }
+}
@@ -0,0 +1,60 @@
+/* trace.h - Trace reader: the file is mapped into memory and its fields parsed in place */
+#include <string>
+#include <vector>
+using namespace std;
+#ifndef _trace_H
+#define _trace_H
+
+// One request of an MSR trace: Timestamp,Hostname,DiskNumber,Type,Offset,Size,ResponseTime
+struct MSRRecord
+{
+    long long int timestamp; // 100ns ticks
+    const char* host;        // points into the mapped file, not terminated
+    int hostLength;
+    int disk;
+    bool write;              // Type is "Write"
+    long long int offset;    // bytes
+    int size;                // bytes
+};
+
+// One request of a TPC-H key trace: whitespace separated <time> <key> <access pattern>
+struct KeyRecord
+{
+    double time;
+    long long int key;
+    char pattern;            // first character of the access pattern token
+};
+
+// Reads a whole trace through mmap (or one read into a buffer where mapping is
+// not possible) and parses numbers with plain digit loops: no iostream, no locale,
+// no copy of a field into a string before it is converted.
+class TraceReader
+{
+private:
+    const char* data;  // the file's bytes
+    const char* end;
+    const char* pos;   // next byte to parse
+    size_t length;
+    bool mapped;       // data is an mmap to release, not buffer
+    std::vector<char> buffer;
+    long long int skipped; // lines that did not parse (headers, truncated rows)
+
+    void skip_line();
+    void skip_blanks(); // whitespace and line breaks, between records
+    void skip_spaces(); // spaces and tabs, between the fields of one record
+    bool parse_int(long long int&);
+    bool parse_double(double&);
+    bool separator(char);
+    bool parse_field(const char*&, int&);
+
+public:
+    TraceReader();
+    ~TraceReader();
+    bool open(const char*); // false if the file cannot be read
+    void close();
+    bool nextMSR(MSRRecord&); // false at the end of the trace
+    bool nextKey(KeyRecord&);
+    long long int bytes() const;   // size of the trace
+    long long int getSkipped() const;
+};
+#endif
@@ -0,0 +1,279 @@
+/* tuner.h - Online parameter tuning: sampled mini-caches with alternative settings steer the live one */
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include "evictsink.h"
+#include "snapshot.h"
+#include "lirs.h"
+#include "cacheus.h"
+using namespace std;
+#ifndef _tuner_H
+#define _tuner_H
+
+#define TUNER_MAX_STEPS 8           // settings on a knob's ladder, one mini-cache each
+#define TUNER_MAX_SHIFT 7           // mini-caches see at most 1 in 2^shift keys (spatial sampling)
+#define TUNER_MIN_SHADOW 64         // but each mini-cache keeps at least this many pages
+#define TUNER_WINDOW_SAMPLES 512    // sampled references between two moves of the live setting
+#define TUNER_DECAY 0.5             // weight of the earlier windows in a setting's score
+#define TUNER_CONFIDENCE 2.0        // the best setting must beat the live one by this many standard deviations
+
+// The parameter a policy exposes to the tuner: a ladder of settings, the one the
+// policy starts with, and how to apply a setting to a live cache
+template <class Cache>
+struct TuningKnob;
+
+template <>
+struct TuningKnob<LIRSCache>
+{
+    static const char* name() { return "lirFraction"; }
+    static int steps() { return 8; }
+    static double value(int i) {
+        static const double v[] = {0.01, 0.05, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99};
+        return v[i];
+    }
+    static int start() { return 0; } // the constructor's 1%
+    static void set(LIRSCache& c, double v) { c.setLIRFraction(v); }
+};
+
+template <>
+struct TuningKnob<CACHEUSCache>
+{
+    static const char* name() { return "writeShare"; }
+    static int steps() { return 8; }
+    static double value(int i) {
+        static const double v[] = {0.01, 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 0.9};
+        return v[i];
+    }
+    static int start() { return 2; } // the constructor's 90/10 split
+    static void set(CACHEUSCache& c, double v) { c.setWriteShare(v); }
+};
+
+// A page policy whose knob is tuned while it runs. One mini-cache per setting on
+// the ladder replays the keys whose hash falls in a 1/2^shift sample, scaled down
+// by the same factor, so its hit ratio estimates that setting's at the full size.
+// After every window the live setting moves one step toward the best-scoring one.
+template <class Cache>
+class TunedCache
+{
+private:
+    typedef TuningKnob<Cache> Knob;
+
+    int csize; // Maximum capacity of the cache
+    Cache live;
+    std::vector<Cache*> minis;
+    int shift;
+    int miniSize;
+    int index; // live setting's place on the ladder
+
+    double score[TUNER_MAX_STEPS];
+    long long int windowHits[TUNER_MAX_STEPS];
+    long long int windowSamples;
+    long long int time; // references seen, never reset
+
+    // Statistics, the live cache keeps the usual ones
+    long long int moves;
+    long long int sampled;
+    long long int miniHits[TUNER_MAX_STEPS];
+    std::vector<std::pair<long long int, double> > trajectory; // (reference, setting) at each move
+    int page_size; // keys are page-aligned byte addresses
+
+    bool in_sample(long long int x) {
+        if (shift == 0) return true;
+        // splitmix64 finaliser, the top bits pick the sample
+        unsigned long long z = (unsigned long long)x + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return (z >> (64 - shift)) == 0;
+    }
+
+    void decide() {
+        int best = index;
+        for (int i = 0; i < Knob::steps(); i++) {
+            score[i] = score[i] * TUNER_DECAY + windowHits[i];
+            windowHits[i] = 0;
+            if (score[i] > score[best]) best = i;
+        }
+        windowSamples = 0;
+        // Neighbouring settings often score within sampling noise of each other, and
+        // every move costs the live cache some of its contents: move only on a lead
+        // larger than the noise of the two hit counts, and one step at a time
+        if (best != index && score[best] - score[index] > TUNER_CONFIDENCE * sqrt(score[best] + score[index])) {
+            index += (best > index) ? 1 : -1;
+            Knob::set(live, Knob::value(index));
+            moves++;
+            trajectory.push_back(std::make_pair(time, Knob::value(index)));
+        }
+    }
+
+public:
+    TunedCache(int n) : csize(n), live(n) {
+        shift = 0;
+        while (shift < TUNER_MAX_SHIFT && (csize >> (shift + 1)) >= TUNER_MIN_SHADOW) shift++;
+        miniSize = max(1, csize >> shift);
+        index = Knob::start();
+        for (int i = 0; i < Knob::steps(); i++) {
+            minis.push_back(new Cache(miniSize, false));
+            Knob::set(*minis[i], Knob::value(i));
+            score[i] = 0;
+            windowHits[i] = 0;
+            miniHits[i] = 0;
+        }
+        windowSamples = 0;
+        time = 0;
+        moves = 0;
+        sampled = 0;
+        page_size = PAGE_SIZE;
+        trajectory.push_back(std::make_pair(0LL, Knob::value(index)));
+
+        std::cout << "Auto-tuning " << Knob::name() << ": " << Knob::steps() << " settings from " << Knob::value(0) << " to " << Knob::value(Knob::steps() - 1) << ", Sample: 1/" << (1 << shift) << ", Mini-cache size: " << miniSize << std::endl;
+    }
+
+    ~TunedCache() {
+        for (size_t i = 0; i < minis.size(); i++) delete minis[i];
+    }
+
+    bool refer(long long int x, string rwtype) {
+        time++;
+        bool hit = live.refer(x, rwtype);
+        if (in_sample(x)) {
+            sampled++;
+            for (int i = 0; i < Knob::steps(); i++) {
+                if (minis[i]->refer(x, rwtype)) {
+                    windowHits[i]++;
+                    miniHits[i]++;
+                }
+            }
+            if (++windowSamples >= TUNER_WINDOW_SAMPLES) {
+                decide();
+            }
+        }
+        return hit;
+    }
+
+    int refer_range(long long int offset, int length, string rwtype) {
+        // the sample is drawn per page, so pages are resolved one at a time in address order
+        int hitPages = 0;
+        long long int first = offset - offset % page_size;
+        for (long long int x = first; x < offset + length; x += page_size) {
+            if (refer(x, rwtype)) hitPages++;
+        }
+        return hitPages;
+    }
+
+    bool contains(long long int x) {
+        return live.contains(x);
+    }
+
+    bool install(long long int x, string rwtype) {
+        // the mini-caches see the same prefetches as the live cache
+        if (in_sample(x)) {
+            for (int i = 0; i < Knob::steps(); i++) minis[i]->install(x, rwtype);
+        }
+        return live.install(x, rwtype);
+    }
+
+    bool remove(long long int x) {
+        if (in_sample(x)) {
+            for (int i = 0; i < Knob::steps(); i++) minis[i]->remove(x);
+        }
+        return live.remove(x);
+    }
+
+    long long int getEvictedDirtyPage() {
+        return live.getEvictedDirtyPage();
+    }
+
+    void setEvictionSink(EvictionSink* s) {
+        live.setEvictionSink(s);
+    }
+
+    void setPageSize(int n) {
+        page_size = n;
+        live.setPageSize(n);
+        for (int i = 0; i < Knob::steps(); i++) minis[i]->setPageSize(n);
+    }
+
+    void resize(int n) {
+        csize = n;
+        // the sample rate stays, the mini-caches keep their share of the cache
+        miniSize = max(1, csize >> shift);
+        live.resize(csize);
+        for (int i = 0; i < Knob::steps(); i++) minis[i]->resize(miniSize);
+    }
+
+    // Snapshot: the live setting and the scores, then the live cache's snapshot
+    // followed by every mini-cache's
+    bool save(std::ostream& out) {
+        snap_header(out, "Tuned", csize);
+        snap_put(out, index);
+        snap_put(out, shift);
+        snap_put(out, windowSamples);
+        for (int i = 0; i < Knob::steps(); i++) {
+            snap_put(out, score[i]);
+            snap_put(out, windowHits[i]);
+        }
+        if (!live.save(out)) return false;
+        for (int i = 0; i < Knob::steps(); i++) {
+            if (!minis[i]->save(out)) return false;
+        }
+        return (bool)out;
+    }
+
+    bool load(std::istream& in) {
+        int s = 0;
+        if (!snap_check(in, "Tuned", csize) || !snap_get(in, index) || !snap_get(in, s)) return false;
+        if (index < 0 || index >= Knob::steps() || s != shift) {
+            std::cerr << "error: snapshot holds a tuned cache with another sample rate" << std::endl;
+            return false;
+        }
+        if (!snap_get(in, windowSamples)) return false;
+        for (int i = 0; i < Knob::steps(); i++) {
+            if (!snap_get(in, score[i]) || !snap_get(in, windowHits[i])) return false;
+        }
+        if (!live.load(in)) return false;
+        for (int i = 0; i < Knob::steps(); i++) {
+            if (!minis[i]->load(in)) return false;
+        }
+        trajectory.push_back(std::make_pair(time, Knob::value(index)));
+        return true;
+    }
+
+    void display() {
+        live.display();
+    }
+
+    void cachehits() {
+        live.cachehits();
+
+        std::cout<< "tuned " << Knob::name() << ": " << Knob::value(index) << ", moves: " << moves << ", sampled: " << sampled << std::endl;
+        std::cout<< "mini hitRatio:";
+        for (int i = 0; i < Knob::steps(); i++) std::cout << " " << Knob::value(i) << " " << ((sampled > 0) ? (float)miniHits[i] / sampled : 0.0);
+        std::cout<< std::endl << "trajectory:";
+        for (size_t i = 0; i < trajectory.size(); i++) std::cout << " " << trajectory[i].first << ":" << trajectory[i].second;
+        std::cout<< std::endl;
+
+        std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+        if (result.is_open()) {
+            result << "Tuned " << Knob::name() << " " << Knob::value(index) << " moves " << moves << " trajectory";
+            for (size_t i = 0; i < trajectory.size(); i++) result << " " << trajectory[i].first << ":" << trajectory[i].second;
+            result << "\n";
+        }
+        result.close();
+    }
+
+    void refresh() {
+        live.refresh();
+        moves = 0;
+        sampled = 0;
+        for (int i = 0; i < Knob::steps(); i++) miniHits[i] = 0;
+    }
+
+    void summary() {
+        live.summary();
+    }
+};
+#endif
@@ -0,0 +1,125 @@
+/* writeback.cpp - Coalescing write-back (destage) buffer Implementation */
+
+#include <iostream>
+#include <fstream>
+#include "writeback.h"
+using namespace std;
+
+// ------------------------------------------------------------------
+// Constructor and Destructor
+// ------------------------------------------------------------------
+WriteBackBuffer::WriteBackBuffer(int high, int low, int page) {
+    highWatermark = max(1, high);
+    lowWatermark = min(max(0, low), highWatermark - 1);
+    pageSize = page;
+
+    dirtyPages = 0;
+    absorbedPages = 0;
+    flushedPages = 0;
+    flushIOs = 0;
+    ioSizes.assign(WB_SIZE_CLASSES, 0);
+
+    std::cout << "Write-back buffer: high watermark " << highWatermark << ", low watermark " << lowWatermark << " pages" << std::endl;
+}
+
+WriteBackBuffer::~WriteBackBuffer() {
+    pages.clear();
+    ioSizes.clear();
+}
+
+// ------------------------------------------------------------------
+// Buffering and destaging
+// ------------------------------------------------------------------
+void WriteBackBuffer::evicted(long long int x, bool dirty) {
+    if (dirty) insert(x);
+}
+
+void WriteBackBuffer::insert(long long int x) {
+    dirtyPages++;
+    // A page rewritten while still buffered is merged into the pending write
+    if (!pages.insert(x).second) {
+        absorbedPages++;
+        return;
+    }
+    if ((int)pages.size() >= highWatermark) {
+        flush(lowWatermark);
+    }
+}
+
+void WriteBackBuffer::flush(int target) {
+    // Destage in ascending address order; each run of contiguous pages
+    // (up to WB_MAX_IO_PAGES) goes to the device as a single write
+    while ((int)pages.size() > target) {
+        std::set<long long int>::iterator it = pages.begin();
+        long long int next = *it;
+        int run = 0;
+        while (it != pages.end() && *it == next && run < WB_MAX_IO_PAGES) {
+            it = pages.erase(it);
+            next += pageSize;
+            run++;
+        }
+
+        flushIOs++;
+        flushedPages += run;
+        int sizeClass = 0;
+        while ((1 << (sizeClass + 1)) <= run && sizeClass < WB_SIZE_CLASSES - 1) sizeClass++;
+        ioSizes[sizeClass]++;
+    }
+}
+
+void WriteBackBuffer::drain() {
+    flush(0);
+}
+
+// ------------------------------------------------------------------
+// Reporting
+// ------------------------------------------------------------------
+long long int WriteBackBuffer::getFlushIOs() {
+    return flushIOs;
+}
+
+long long int WriteBackBuffer::getFlushedPages() {
+    return flushedPages;
+}
+
+void WriteBackBuffer::merge(const WriteBackBuffer& other) {
+    dirtyPages += other.dirtyPages;
+    absorbedPages += other.absorbedPages;
+    flushedPages += other.flushedPages;
+    flushIOs += other.flushIOs;
+    for (int i = 0; i < WB_SIZE_CLASSES; i++) ioSizes[i] += other.ioSizes[i];
+}
+
+void WriteBackBuffer::report(string policy) {
+    // Flush ratio: pages written to the device per dirty page evicted, at most 1.0; the
+    // rest were rewritten while buffered and absorbed. This is not write amplification:
+    // every flushed page is written exactly once.
+    // I/O ratio: device write requests per dirty page evicted (1.0 without coalescing).
+    float flushRatio = (dirtyPages > 0) ? (float)flushedPages / dirtyPages : 0.0;
+    float ioRatio = (dirtyPages > 0) ? (float)flushIOs / dirtyPages : 0.0;
+    float avgIOSize = (flushIOs > 0) ? (float)flushedPages * pageSize / flushIOs / 1024 : 0.0;
+
+    std::cout << "dirtyPages: " << dirtyPages << ", absorbedPages: " << absorbedPages << ", flushedPages: " << flushedPages << ", flushIOs: " << flushIOs << ", flushRatio: " << flushRatio << ", ioRatio: " << ioRatio << ", avgIOSize(KB): " << avgIOSize << std::endl;
+    std::cout << "flushed I/O sizes (pages):";
+    for (int i = 0; i < WB_SIZE_CLASSES; i++) {
+        std::cout << " " << (1 << i) << ((i == WB_SIZE_CLASSES - 1) ? "+" : "") << ":" << ioSizes[i];
+    }
+    std::cout << std::endl;
+
+    std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+    if (result.is_open()) {
+        result << policy << " WriteBack" << " highWatermark " << highWatermark << " lowWatermark " << lowWatermark << " dirtyPages " << dirtyPages << " absorbedPages " << absorbedPages << " flushedPages " << flushedPages << " flushIOs " << flushIOs << " flushRatio " << flushRatio << " ioRatio " << ioRatio << " avgIOSizeKB " << avgIOSize << " ioSizes";
+        for (int i = 0; i < WB_SIZE_CLASSES; i++) result << " " << ioSizes[i];
+        result << "\n";
+    }
+    result.close();
+}
+
+void WriteBackBuffer::refresh() {
+    // pages still buffered are carried over, their destage is counted against them
+    dirtyPages = (long long int)pages.size();
+    absorbedPages = 0;
+    flushedPages = 0;
+    flushIOs = 0;
+    ioSizes.assign(WB_SIZE_CLASSES, 0);
+}
@@ -0,0 +1,49 @@
+/* writeback.h - Coalescing write-back (destage) buffer for dirty evictions */
+#include <string>
+#include <set>
+#include <vector>
+#include "evictsink.h"
+using namespace std;
+#ifndef _writeback_H
+#define _writeback_H
+
+#define WB_MAX_IO_PAGES 256     // largest coalesced write issued to the device, in pages
+#define WB_SIZE_CLASSES 9       // flushed I/O size histogram: 1, 2, 4, ..., 256+ pages
+
+class WriteBackBuffer : public EvictionSink
+{
+private:
+    int highWatermark; // start flushing when this many dirty pages are buffered
+    int lowWatermark;  // stop flushing once the buffer drains to this many pages
+    int pageSize;      // contiguous pages are pageSize bytes apart
+
+    // Buffered dirty pages ordered by address so contiguous pages can be merged
+    std::set<long long int> pages;
+
+    // Statistics
+    long long int dirtyPages;      // dirty victims handed to the buffer by the policy
+    long long int absorbedPages;   // victims already buffered (rewritten before destage)
+    long long int flushedPages;    // pages written to the backing device
+    long long int flushIOs;        // write I/Os issued to the backing device
+    std::vector<long long int> ioSizes; // flushed I/Os per power-of-two size class
+
+    void flush(int target);
+
+public:
+    WriteBackBuffer(int, int, int);
+    ~WriteBackBuffer();
+
+    // Called by a policy for every victim, only dirty ones are buffered
+    void evicted(long long int, bool);
+    void insert(long long int);
+    // Destage everything left in the buffer (end of replay)
+    void drain();
+
+    long long int getFlushIOs();
+    long long int getFlushedPages();
+    // Fold in another drained buffer's statistics (partitioned replay: one buffer per shard)
+    void merge(const WriteBackBuffer&);
+    void report(string policy);
+    void refresh();
+};
+#endif